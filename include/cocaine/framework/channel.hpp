@@ -17,6 +17,7 @@
 #pragma once
 
 #include <tuple>
+#include <type_traits>
 
 #include <cocaine/rpc/protocol.hpp>
 
@@ -26,6 +27,17 @@ namespace cocaine {
 
 namespace framework {
 
+/// Checks whether the given event is mute, i.e. has neither upstream nor dispatch, which means
+/// that there is no need to create a channel to send it.
+template<class Event>
+struct is_mute :
+    public std::integral_constant<
+        bool,
+        std::is_void<typename io::event_traits<Event>::upstream_type>::value &&
+        std::is_void<typename io::event_traits<Event>::dispatch_type>::value
+    >
+{};
+
 /// The channel class represents a named tuple channel.
 ///
 /// Channels are always associated with some concrete Event.
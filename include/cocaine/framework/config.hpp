@@ -0,0 +1,4 @@
+#pragma once
+
+/// Use internal logging system (much verbose, so spam, wow).
+/* #undef COCAINE_FRAMEWORK_HAS_INTERNAL_TRACING */
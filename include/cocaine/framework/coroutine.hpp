@@ -0,0 +1,298 @@
+/*
+    Copyright (c) 2015 Evgeny Safronov <division494@gmail.com>
+    Copyright (c) 2011-2015 Other contributors as noted in the AUTHORS file.
+    This file is part of Cocaine.
+    Cocaine is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+    Cocaine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU Lesser General Public License for more details.
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/// Coroutine support is enabled automatically when the compiler implements C++20 coroutines. It can
+/// be forced off by defining COCAINE_FRAMEWORK_HAS_COROUTINES to 0 before including this header.
+#if !defined(COCAINE_FRAMEWORK_HAS_COROUTINES)
+#   if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L && defined(__has_include)
+#       if __has_include(<coroutine>)
+#           define COCAINE_FRAMEWORK_HAS_COROUTINES 1
+#       endif
+#   endif
+#endif
+
+#if !defined(COCAINE_FRAMEWORK_HAS_COROUTINES)
+#   define COCAINE_FRAMEWORK_HAS_COROUTINES 0
+#endif
+
+#if COCAINE_FRAMEWORK_HAS_COROUTINES
+
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <utility>
+
+#include "cocaine/framework/forwards.hpp"
+#include "cocaine/framework/util/future.hpp"
+
+namespace cocaine { namespace framework {
+
+namespace detail { namespace coroutine {
+
+/// Per-thread pool of coroutine frames.
+///
+/// Frames are grouped into size classes with 64 byte granularity. A frame released on a thread
+/// other than the one it was allocated on, which is the common case when a coroutine finishes on
+/// the io thread, migrates to the pool of the releasing thread. Frames larger than the biggest
+/// class and frames exceeding the pool capacity are passed to the global allocator, as well as
+/// frames released by a thread after its pool has been destroyed.
+class frame_pool_t {
+public:
+    static constexpr std::size_t GRANULARITY = 64;
+    static constexpr std::size_t CLASSES = 16;
+    static constexpr std::size_t CAPACITY = 64;
+
+private:
+    struct node_t {
+        node_t* next;
+    };
+
+    struct bucket_t {
+        node_t* head;
+        std::size_t size;
+    };
+
+    std::array<bucket_t, CLASSES> buckets;
+
+public:
+    frame_pool_t() {
+        buckets.fill(bucket_t{nullptr, 0});
+    }
+
+    frame_pool_t(const frame_pool_t&) = delete;
+    frame_pool_t& operator=(const frame_pool_t&) = delete;
+
+    ~frame_pool_t() {
+        for (auto& bucket : buckets) {
+            while (bucket.head) {
+                auto node = bucket.head;
+                bucket.head = node->next;
+                ::operator delete(node);
+            }
+        }
+    }
+
+    /// Returns the pool of the calling thread, or null if it has already been destroyed, which
+    /// happens when a frame is released by a destructor of another thread-local object.
+    static
+    frame_pool_t*
+    local() {
+        // Trivially destructible, so it is still valid after the pool is destroyed.
+        static thread_local bool destroyed = false;
+
+        struct holder_t {
+            frame_pool_t pool;
+
+            ~holder_t() {
+                destroyed = true;
+            }
+        };
+
+        static thread_local holder_t holder;
+        return destroyed ? nullptr : &holder.pool;
+    }
+
+    void*
+    allocate(std::size_t size) {
+        const auto id = index(size);
+        if (id >= CLASSES) {
+            return ::operator new(size);
+        }
+
+        auto& bucket = buckets[id];
+        if (bucket.head) {
+            auto node = bucket.head;
+            bucket.head = node->next;
+            --bucket.size;
+            return node;
+        }
+
+        return ::operator new((id + 1) * GRANULARITY);
+    }
+
+    void
+    deallocate(void* ptr, std::size_t size) noexcept {
+        const auto id = index(size);
+        if (id >= CLASSES || buckets[id].size >= CAPACITY) {
+            ::operator delete(ptr);
+            return;
+        }
+
+        auto& bucket = buckets[id];
+        bucket.head = ::new(ptr) node_t{bucket.head};
+        ++bucket.size;
+    }
+
+private:
+    static
+    std::size_t
+    index(std::size_t size) noexcept {
+        return size == 0 ? 0 : (size - 1) / GRANULARITY;
+    }
+};
+
+/// Routes coroutine frame allocations through the per-thread pool.
+struct frame_allocator_t {
+    static
+    void*
+    operator new(std::size_t size) {
+        if (auto pool = frame_pool_t::local()) {
+            return pool->allocate(size);
+        }
+
+        return ::operator new(size);
+    }
+
+    static
+    void
+    operator delete(void* ptr, std::size_t size) noexcept {
+        if (auto pool = frame_pool_t::local()) {
+            pool->deallocate(ptr, size);
+        } else {
+            ::operator delete(ptr);
+        }
+    }
+};
+
+/// Awaits the given future, owning it while the coroutine is suspended.
+///
+/// The coroutine is resumed directly from the thread that fulfills the future without going through
+/// any executor. For futures returned from sessions, senders and receivers this is the io thread
+/// of the corresponding event loop.
+template<class... Args>
+class future_awaiter {
+    framework::future<Args...> future_;
+
+public:
+    explicit
+    future_awaiter(framework::future<Args...>&& future) :
+        future_(std::move(future))
+    {}
+
+    bool
+    await_ready() const {
+        return future_.ready();
+    }
+
+    void
+    await_suspend(std::coroutine_handle<> handle) {
+        // The future may become ready between await_ready and here, in that case the coroutine is
+        // resumed inline. Nothing is touched after resuming, because it may destroy the awaiter.
+        future_.when_ready(executor_t(), [handle](framework::future<Args...>&) {
+            handle.resume();
+        });
+    }
+
+    auto
+    await_resume() -> typename detail::future::get_visitor<Args...>::result_type {
+        return future_.get();
+    }
+};
+
+/// Common part of the promise type for coroutines returning a framework future.
+///
+/// Coroutines start eagerly and destroy themselves on completion, so the returned future is the
+/// only thing needed to track them.
+template<class T>
+class promise_base : public frame_allocator_t {
+protected:
+    framework::promise<T> promise;
+
+public:
+    auto
+    get_return_object() -> framework::future<T> {
+        return promise.get_future();
+    }
+
+    std::suspend_never
+    initial_suspend() const noexcept {
+        return {};
+    }
+
+    std::suspend_never
+    final_suspend() const noexcept {
+        return {};
+    }
+
+    void
+    unhandled_exception() {
+        promise.set_exception(std::current_exception());
+    }
+};
+
+template<class T>
+class promise_type : public promise_base<T> {
+public:
+    template<class U>
+    void
+    return_value(U&& value) {
+        this->promise.set_value(std::forward<U>(value));
+    }
+};
+
+template<>
+class promise_type<void> : public promise_base<void> {
+public:
+    void
+    return_void() {
+        this->promise.set_value();
+    }
+};
+
+}} // namespace detail::coroutine
+
+/// Makes framework futures awaitable.
+///
+/// This covers every asynchronous operation of the framework: service invocations, sender::send,
+/// receiver::recv and worker::sender::write all return futures. Sender operations resolve to the
+/// next sender, which should be used for further sends:
+///
+///     auto tx = co_await channel.tx.send<protocol::chunk>("le message");
+///     auto chunk = co_await channel.rx.recv();
+///
+/// Awaiting doesn't block and doesn't post to any executor: the coroutine resumes on the thread
+/// that completed the operation, usually the io thread, so long computations after co_await should
+/// be offloaded.
+template<class... Args>
+auto
+operator co_await(future<Args...>&& future) -> detail::coroutine::future_awaiter<Args...> {
+    return detail::coroutine::future_awaiter<Args...>(std::move(future));
+}
+
+/// Awaiting consumes the future, so it must be explicitly moved to make it clear that the future
+/// can't be used after that:
+///
+///     auto value = co_await std::move(future);
+template<class... Args>
+auto
+operator co_await(future<Args...>& future) -> detail::coroutine::future_awaiter<Args...> = delete;
+
+}} // namespace cocaine::framework
+
+/// Allows coroutines to return framework futures, which are fulfilled with the coroutine result.
+///
+/// Such coroutines can be registered as worker handlers directly, because the returned future is
+/// ignored by the dispatcher while the coroutine keeps running until it completes.
+template<class T, class... Args>
+struct std::coroutine_traits<cocaine::framework::future<T>, Args...> {
+    typedef cocaine::framework::detail::coroutine::promise_type<T> promise_type;
+};
+
+#endif // COCAINE_FRAMEWORK_HAS_COROUTINES
@@ -16,8 +16,10 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <unordered_map>
+#include <vector>
 
 #include <boost/asio/ip/tcp.hpp>
 
@@ -32,6 +34,9 @@
 #include "cocaine/framework/receiver.hpp"
 
 #include "cocaine/framework/detail/decoder.hpp"
+#include "cocaine/framework/detail/metrics.hpp"
+#include "cocaine/framework/detail/slab.hpp"
+#include "cocaine/framework/detail/writer.hpp"
 
 namespace cocaine { namespace framework {
 
@@ -55,11 +60,17 @@ class basic_session_t:
     typedef asio::ip::tcp protocol_type;
     typedef protocol_type::socket socket_type;
     typedef io::transport<protocol_type, io::encoder_t, detail::decoder_t> transport_type;
+    typedef detail::writer_t<socket_type> writer_type;
+
+    /// Channels are owned by their sender and receiver handles only, so the map refers to them
+    /// weakly.
+    struct channel_entry_t {
+        std::weak_ptr<shared_state_t> state;
+        /// Time of the invocation, which is reset after the first response is received.
+        std::chrono::steady_clock::time_point start;
+    };
 
-    typedef std::unordered_map<
-        std::uint64_t,
-        std::shared_ptr<shared_state_t>
-    > channel_map_type;
+    typedef std::unordered_map<std::uint64_t, channel_entry_t> channel_map_type;
 
     class push_t;
 
@@ -91,12 +102,36 @@ private:
     decoded_message message;
 
     synchronized<std::shared_ptr<transport_type>> transport;
+    /// Write queue of the current transport socket. All writes go through it instead of the
+    /// transport writer.
+    synchronized<std::shared_ptr<writer_type>> writer;
     synchronized<channel_map_type> channels;
+    /// Memory of released channels, reused by new ones.
+    std::shared_ptr<detail::slab_t> slab;
+    /// Memory of released receiver handle counters, reused by new channels.
+    std::shared_ptr<detail::slab_t> receivers;
 
     std::atomic<bool> hard_shutdown_;
 
     std::mutex mutex;
 
+    /// Metrics shared by all sessions of the same event loop.
+    struct metrics_t {
+        detail::metrics::gauge_t& channels;
+        detail::metrics::counter_t& frames_read;
+        detail::metrics::counter_t& bytes_read;
+        detail::metrics::counter_t& frames_written;
+        detail::metrics::counter_t& bytes_written;
+        detail::metrics::counter_t& connects;
+        detail::metrics::counter_t& errors;
+        detail::metrics::histogram_t& write_latency;
+        /// Time from an invocation to its first response, including continuations of the receiver
+        /// future invoked inline.
+        detail::metrics::histogram_t& response_latency;
+
+        explicit metrics_t(detail::metrics::registry_t& registry);
+    } metrics;
+
 public:
     /// Constructs a disconnected session.
     ///
@@ -153,12 +188,45 @@ public:
     future<invoke_result>
     invoke(encode_callback_t encode_callback);
 
-    /// TODO: Implement: invoke_mute - sends an invoke event without channel creation.
+    /// Sends the given number of invocation events using a single write operation and creates a
+    /// new channel for each of them.
+    ///
+    /// The encode callback receives the first of consecutive channel ids reserved for the batch and
+    /// must encode exactly the given number of invocations. Channels are returned in the order of
+    /// their ids.
+    ///
+    /// \threadsafe
+    future<std::vector<invoke_result>>
+    invoke_many(std::size_t count, encode_callback_t encode_callback);
+
+    /// Sends a mute invocation event, i.e. an event with no upstream and no dispatch, without
+    /// channel creation.
+    ///
+    /// Only the channel id is allocated, there is no channel bookkeeping at all.
+    ///
+    /// \threadsafe
+    future<void>
+    invoke_mute(encode_callback_t encode_callback);
+
+    /// Sends the given number of mute invocation events using a single write operation.
+    ///
+    /// The encode callback receives the first of consecutive channel ids reserved for the batch and
+    /// must encode exactly the given number of invocations.
+    ///
+    /// \threadsafe
+    future<void>
+    invoke_mute_many(std::size_t count, encode_callback_t encode_callback);
 
     /// Sends an event without creating a new channel.
     future<void>
     push(io::encoder_t::message_type&& message);
 
+    /// Sends an event without creating a new channel, followed by the given blob without copying.
+    ///
+    /// \pre the message must end with a raw header, announcing the blob size.
+    future<void>
+    push(io::encoder_t::message_type&& message, blob_t blob);
+
     /*!
      * Unsubscribes a channel with the given span.
      *
@@ -181,6 +249,11 @@ private:
 
     void
     pull(std::shared_ptr<transport_type> transport);
+
+    /// Drops the current transport together with its writer, so the socket is closed after all
+    /// pending operations complete.
+    void
+    detach();
 };
 
 }} // namespace cocaine::framework
@@ -0,0 +1,166 @@
+/*
+    Copyright (c) 2015 Evgeny Safronov <division494@gmail.com>
+    Copyright (c) 2011-2015 Other contributors as noted in the AUTHORS file.
+    This file is part of Cocaine.
+    Cocaine is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+    Cocaine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU Lesser General Public License for more details.
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+
+namespace cocaine {
+
+namespace framework {
+
+namespace detail {
+
+/// Lock-free bounded multi-producer multi-consumer queue.
+///
+/// Each cell carries a sequence number, which tells producers and consumers whether the cell is
+/// ready to be written or read, so the only contention point is a single CAS on the position.
+///
+/// \note the capacity must be a power of two.
+template<class T>
+class bounded_queue_t {
+    static constexpr std::size_t cacheline = 64;
+
+    struct cell_t {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<cell_t[]> buffer;
+    const std::size_t mask;
+
+    // Producers and consumers positions live on different cache lines to avoid false sharing.
+    alignas(cacheline) std::atomic<std::size_t> enqueue_position;
+    alignas(cacheline) std::atomic<std::size_t> dequeue_position;
+
+    /// Checks the capacity before anything is allocated for it.
+    static
+    auto
+    validate(std::size_t capacity) -> std::size_t {
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+            throw std::invalid_argument("queue capacity must be a power of two");
+        }
+
+        return capacity;
+    }
+
+public:
+    explicit bounded_queue_t(std::size_t capacity) :
+        buffer(new cell_t[validate(capacity)]),
+        mask(capacity - 1),
+        enqueue_position(0),
+        dequeue_position(0)
+    {
+        for (std::size_t id = 0; id < capacity; ++id) {
+            buffer[id].sequence.store(id, std::memory_order_relaxed);
+        }
+    }
+
+    bounded_queue_t(const bounded_queue_t&) = delete;
+    bounded_queue_t& operator=(const bounded_queue_t&) = delete;
+
+    auto capacity() const noexcept -> std::size_t {
+        return mask + 1;
+    }
+
+    /// Returns the approximate number of elements in the queue.
+    auto size() const noexcept -> std::size_t {
+        const auto enqueued = enqueue_position.load(std::memory_order_relaxed);
+        const auto dequeued = dequeue_position.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    /// Tries to push the value into the queue.
+    ///
+    /// \return false if the queue is full, leaving the value untouched.
+    auto push(T& value) -> bool {
+        cell_t* cell;
+        auto position = enqueue_position.load(std::memory_order_relaxed);
+
+        while (true) {
+            cell = &buffer[position & mask];
+            const auto sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+            if (diff == 0) {
+                if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = std::move(value);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Pushes the value into the queue, dropping the oldest values while the queue is full.
+    ///
+    /// \return the number of dropped values.
+    auto force_push(T& value) -> std::size_t {
+        std::size_t dropped = 0;
+
+        while (!push(value)) {
+            T oldest;
+            if (pop(oldest)) {
+                ++dropped;
+            }
+        }
+
+        return dropped;
+    }
+
+    /// Tries to pop the value from the queue.
+    ///
+    /// \return false if the queue is empty.
+    auto pop(T& value) -> bool {
+        cell_t* cell;
+        auto position = dequeue_position.load(std::memory_order_relaxed);
+
+        while (true) {
+            cell = &buffer[position & mask];
+            const auto sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+
+            if (diff == 0) {
+                if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = dequeue_position.load(std::memory_order_relaxed);
+            }
+        }
+
+        value = std::move(cell->value);
+        cell->sequence.store(position + mask + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+} // namespace detail
+
+} // namespace framework
+
+} // namespace cocaine
@@ -0,0 +1,139 @@
+/*
+    Copyright (c) 2015 Evgeny Safronov <division494@gmail.com>
+    Copyright (c) 2011-2015 Other contributors as noted in the AUTHORS file.
+    This file is part of Cocaine.
+    Cocaine is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+    Cocaine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU Lesser General Public License for more details.
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "cocaine/framework/receiver.hpp"
+#include "cocaine/framework/sender.hpp"
+
+#include "cocaine/framework/detail/shared_state.hpp"
+#include "cocaine/framework/detail/slab.hpp"
+
+namespace cocaine { namespace framework { namespace detail {
+
+/// Default payload of a channel, which is nothing.
+///
+/// \internal
+struct no_payload_t {};
+
+/// Fuses the sender, the receiver and the shared state of a single channel into a single object,
+/// which is allocated at once and shares a single reference counter.
+///
+/// The block may also carry a payload, which lives as long as the channel, like per-invocation
+/// bookkeeping of the worker, saving another allocation.
+///
+/// The block is destroyed after all its handles are released. Sessions must refer to the shared
+/// state weakly, otherwise the block would never die.
+///
+/// \internal
+template<class Session, class Payload = no_payload_t>
+class channel_block_t {
+public:
+    typedef basic_receiver_t<Session> receiver_type;
+
+    shared_state_t state;
+    basic_sender_t<Session> tx;
+    basic_receiver_t<Session> rx;
+    Payload payload;
+
+    template<class... Args>
+    channel_block_t(std::uint64_t id, const std::shared_ptr<Session>& session, Args&&... args) :
+        tx(id, session),
+        // The receiver lives inside the block, so it must not own the block it lives in.
+        rx(id, session, std::shared_ptr<shared_state_t>(std::shared_ptr<shared_state_t>(), &state)),
+        payload(std::forward<Args>(args)...)
+    {}
+};
+
+/// Releases the receiver handle of a channel, revoking the channel at once, so messages nobody
+/// waits for anymore are dropped, even if the block is still kept alive by its other handles.
+///
+/// \internal
+template<class Block>
+class receiver_release_t {
+    std::shared_ptr<Block> block;
+
+public:
+    explicit
+    receiver_release_t(std::shared_ptr<Block> block) :
+        block(std::move(block))
+    {}
+
+    void
+    operator()(typename Block::receiver_type* rx) {
+        rx->revoke();
+        block.reset();
+    }
+};
+
+/// Handles of a single channel, all of them owning the same block.
+///
+/// The receiver handle has a reference counter of its own to revoke the channel after it is
+/// released. The payload handle is null if there is no payload.
+///
+/// \internal
+template<class Session, class Payload = no_payload_t>
+struct channel_handles_t {
+    std::shared_ptr<basic_sender_t<Session>> tx;
+    std::shared_ptr<basic_receiver_t<Session>> rx;
+    std::shared_ptr<shared_state_t> state;
+    std::shared_ptr<Payload> payload;
+};
+
+template<class Block>
+std::shared_ptr<no_payload_t>
+payload_of(const std::shared_ptr<Block>&, no_payload_t*) {
+    return nullptr;
+}
+
+template<class Block, class Payload>
+std::shared_ptr<Payload>
+payload_of(const std::shared_ptr<Block>& block, Payload*) {
+    return std::shared_ptr<Payload>(block, &block->payload);
+}
+
+/// Creates a new channel with the given id, taking memory for the block and for the receiver
+/// handle counter from the given slabs. Each slab serves blocks of a single size. The payload, if
+/// any, is constructed from the given arguments.
+///
+/// \internal
+template<class Session, class Payload = no_payload_t, class... Args>
+auto
+make_channel(std::uint64_t id,
+             const std::shared_ptr<Session>& session,
+             const std::shared_ptr<slab_t>& slab,
+             const std::shared_ptr<slab_t>& receivers,
+             Args&&... args)
+    -> channel_handles_t<Session, Payload>
+{
+    typedef channel_block_t<Session, Payload> block_type;
+
+    auto block = std::allocate_shared<block_type>(slab_allocator_t<block_type>(slab), id, session, std::forward<Args>(args)...);
+
+    return channel_handles_t<Session, Payload>{
+        std::shared_ptr<basic_sender_t<Session>>(block, &block->tx),
+        std::shared_ptr<basic_receiver_t<Session>>(&block->rx, receiver_release_t<block_type>(block),
+            slab_allocator_t<block_type>(receivers)),
+        std::shared_ptr<shared_state_t>(block, &block->state),
+        payload_of(block, static_cast<Payload*>(nullptr))
+    };
+}
+
+}}} // namespace cocaine::framework::detail
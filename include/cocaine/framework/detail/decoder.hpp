@@ -17,7 +17,10 @@
 #pragma once
 
 #include <stddef.h>
+
+#include <cstdint>
 #include <system_error>
+#include <vector>
 
 #include <cocaine/hpack/header.hpp>
 
@@ -29,14 +32,53 @@ class decoded_message;
 
 namespace detail {
 
+/// Incrementally determines the size of a MessagePack object arriving in pieces.
+///
+/// The walker only looks at type headers and skips raw bodies using their declared lengths, keeping
+/// its position between calls. Thus each byte of the object is visited at most once no matter how
+/// many reads it takes to receive it.
+///
+/// \internal
+class frame_walker_t {
+    /// Offset of the next header to be read relatively to the object beginning.
+    size_t offset;
+
+    /// Number of elements left to be read in each of currently open containers.
+    std::vector<std::uint64_t> stack;
+
+public:
+    /// Maximum nesting depth, deeper objects are treated as malformed.
+    static constexpr size_t MAX_DEPTH = 1024;
+
+    frame_walker_t();
+
+    /// Continues walking the object, which starts at the beginning of the given data.
+    ///
+    /// The data must start with the same object on every call, with more of its bytes available
+    /// than before.
+    ///
+    /// \returns the object size if it is completely available; otherwise returns zero and sets
+    /// either insufficient bytes or parse error code.
+    size_t
+    walk(const char* data, size_t size, std::error_code& ec);
+
+    /// Forgets the current object, preparing the walker for the next one.
+    void
+    reset();
+};
+
 /// The decoder represents streaming MessagePack decoding.
 ///
-/// \note this class does explicit memory copying to the message_type object.
+/// Incomplete frames are tracked using the frame walker, so the frame is parsed and copied to the
+/// message_type object only once, after all of its bytes have been received.
+///
 /// \internal
 struct decoder_t {
     typedef decoded_message message_type;
     hpack::header_table_t header_table;
 
+    frame_walker_t walker;
+
     size_t decode(const char* data, size_t size, message_type& message, std::error_code& ec);
 };
 
@@ -0,0 +1,105 @@
+/*
+    Copyright (c) 2015 Evgeny Safronov <division494@gmail.com>
+    Copyright (c) 2011-2015 Other contributors as noted in the AUTHORS file.
+    This file is part of Cocaine.
+    Cocaine is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+    Cocaine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU Lesser General Public License for more details.
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <boost/asio/ip/tcp.hpp>
+
+#include <asio/deadline_timer.hpp>
+
+#include "cocaine/framework/forwards.hpp"
+#include "cocaine/framework/util/future.hpp"
+
+#include "cocaine/framework/detail/forwards.hpp"
+
+namespace cocaine { namespace framework { namespace detail {
+
+/// Locator endpoints, which are either given explicitly or resolved from host names.
+///
+/// Host names are resolved lazily on the first request without blocking the given event loop. All
+/// lookups are started at once, but asio performs them one after another on its internal resolver
+/// thread. After that they are periodically refreshed in the background, keeping the last
+/// successfully resolved endpoints on failures.
+///
+/// \internal
+/// \threadsafe
+class locations_t : public std::enable_shared_from_this<locations_t> {
+public:
+    typedef boost::asio::ip::tcp::endpoint endpoint_type;
+    typedef std::tuple<std::string, std::uint16_t> host_type;
+
+private:
+    const std::vector<host_type> hosts;
+    /// Event loop used for resolving, null if the endpoints are given explicitly.
+    loop_t* const loop;
+    const boost::posix_time::seconds interval;
+    std::unique_ptr<asio::deadline_timer> timer;
+
+    std::mutex mutex;
+    std::vector<endpoint_type> endpoints_;
+    bool resolved;
+    bool resolving;
+    bool stopped;
+    std::deque<task<std::vector<endpoint_type>>::promise_type> queue;
+
+    class collector_t;
+
+public:
+    /// Constructs locations consisting of the given endpoints.
+    explicit
+    locations_t(std::vector<endpoint_type> endpoints);
+
+    /// Constructs locations, which are resolved from the given hosts using the given event loop
+    /// and refreshed with the given interval.
+    locations_t(std::vector<host_type> hosts, loop_t& loop, boost::posix_time::seconds interval);
+
+    ~locations_t();
+
+    /// Returns the last resolved endpoints without waiting, which may be empty.
+    std::vector<endpoint_type>
+    endpoints();
+
+    /// Returns a future with endpoints, which is set either immediately if they are already known,
+    /// or after the first resolving completes.
+    auto
+    get() -> task<std::vector<endpoint_type>>::future_type;
+
+    /// Stops refreshing, allowing the event loop to finish.
+    void
+    stop();
+
+private:
+    /// \pre the resolving flag is set.
+    void
+    resolve();
+
+    void
+    on_resolve(std::vector<endpoint_type> endpoints, const std::error_code& ec);
+
+    /// \pre the mutex is locked.
+    void
+    schedule();
+};
+
+}}} // namespace cocaine::framework::detail
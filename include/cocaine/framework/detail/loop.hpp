@@ -17,6 +17,7 @@
 #pragma once
 
 #include "cocaine/framework/detail/forwards.hpp"
+#include "cocaine/framework/detail/metrics.hpp"
 
 namespace cocaine {
 
@@ -29,14 +30,25 @@ struct event_loop_t {
     loop_type& loop;
     loop_type& userloop;
 
+    /// Metrics of all sessions running on this loop.
+    detail::metrics::registry_t& metrics;
+
     explicit event_loop_t(loop_type& loop) noexcept :
         loop(loop),
-        userloop(loop)
+        userloop(loop),
+        metrics(detail::metrics::registry_t::global())
+    {}
+
+    event_loop_t(loop_type& loop, detail::metrics::registry_t& metrics) noexcept :
+        loop(loop),
+        userloop(loop),
+        metrics(metrics)
     {}
 
     event_loop_t(loop_type& ioloop, loop_type& userloop) noexcept :
         loop(ioloop),
-        userloop(userloop)
+        userloop(userloop),
+        metrics(detail::metrics::registry_t::global())
     {}
 };
 
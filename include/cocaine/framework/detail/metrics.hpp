@@ -0,0 +1,216 @@
+/*
+    Copyright (c) 2015 Evgeny Safronov <division494@gmail.com>
+    Copyright (c) 2011-2015 Other contributors as noted in the AUTHORS file.
+    This file is part of Cocaine.
+    Cocaine is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+    Cocaine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU Lesser General Public License for more details.
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "cocaine/framework/metrics.hpp"
+
+namespace cocaine {
+namespace framework {
+namespace detail {
+namespace metrics {
+
+/// Returns a small index of the current thread, which is used to pick a shard.
+auto thread_index() noexcept -> std::size_t;
+
+/// The number of shards each sharded metric consists of.
+constexpr std::size_t SHARDS = 16;
+
+/// Sharded integer, which allows to update it concurrently from multiple threads with no
+/// contention on a single cache line.
+///
+/// Reading sums all shards, so it is relatively slow and is meant for snapshots only.
+template<class T>
+class sharded_t {
+    // Padding instead of alignment, because over-aligned dynamic allocations are not supported
+    // until C++17. Values are still placed 64 bytes apart, so no two of them share a cache line.
+    struct shard_t {
+        std::atomic<T> value;
+        char padding[64 - sizeof(std::atomic<T>)];
+    };
+
+    std::array<shard_t, SHARDS> shards;
+
+public:
+    sharded_t() {
+        for (auto& shard : shards) {
+            shard.value.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    sharded_t(const sharded_t&) = delete;
+    sharded_t& operator=(const sharded_t&) = delete;
+
+    void
+    add(T value) noexcept {
+        shards[thread_index() % SHARDS].value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    auto
+    load() const noexcept -> T {
+        T result = 0;
+        for (const auto& shard : shards) {
+            result += shard.value.load(std::memory_order_relaxed);
+        }
+
+        return result;
+    }
+};
+
+/// Monotonically increasing counter.
+class counter_t {
+    sharded_t<std::uint64_t> value;
+
+public:
+    void
+    inc(std::uint64_t delta = 1) noexcept {
+        value.add(delta);
+    }
+
+    auto
+    load() const noexcept -> std::uint64_t {
+        return value.load();
+    }
+};
+
+/// Gauge, representing a value that can both increase and decrease.
+class gauge_t {
+    sharded_t<std::int64_t> value;
+
+public:
+    void
+    inc(std::int64_t delta = 1) noexcept {
+        value.add(delta);
+    }
+
+    void
+    dec(std::int64_t delta = 1) noexcept {
+        value.add(-delta);
+    }
+
+    auto
+    load() const noexcept -> std::int64_t {
+        return value.load();
+    }
+};
+
+/// Log-linear histogram in HDR-histogram style.
+///
+/// Each power of two range is split into 16 linear sub-buckets, which gives a relative error of
+/// at most 1/16 over the whole 64-bit range using a fixed number of buckets and no allocations on
+/// recording.
+///
+/// Buckets are not sharded, because concurrent recordings rarely hit the same bucket, but count
+/// and sum are.
+class histogram_t {
+public:
+    static constexpr unsigned int PRECISION = 4;
+    static constexpr std::size_t SUBBUCKETS = 1 << PRECISION;
+    static constexpr std::size_t BUCKETS = (64 - PRECISION + 1) * SUBBUCKETS;
+
+private:
+    std::array<std::atomic<std::uint64_t>, BUCKETS> buckets;
+    counter_t count;
+    counter_t sum;
+
+public:
+    histogram_t();
+
+    histogram_t(const histogram_t&) = delete;
+    histogram_t& operator=(const histogram_t&) = delete;
+
+    void
+    record(std::uint64_t value) noexcept {
+        buckets[index(value)].fetch_add(1, std::memory_order_relaxed);
+        count.inc();
+        sum.inc(value);
+    }
+
+    /// Records the time elapsed since the given time point in microseconds.
+    void
+    record_since(std::chrono::steady_clock::time_point start) noexcept {
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+    }
+
+    auto
+    snapshot() const -> histogram_snapshot_t;
+
+    /// Returns the bucket index of the given value.
+    static
+    auto
+    index(std::uint64_t value) noexcept -> std::size_t {
+        if (value < SUBBUCKETS) {
+            return value;
+        }
+
+        const unsigned int msb = 63 - __builtin_clzll(value);
+        const unsigned int shift = msb - PRECISION;
+        return (shift + 1) * SUBBUCKETS + ((value >> shift) - SUBBUCKETS);
+    }
+
+    /// Returns the greatest value, which falls into the bucket with the given index.
+    static
+    auto
+    upper_bound(std::size_t index) noexcept -> std::uint64_t;
+};
+
+/// Named metrics storage.
+///
+/// Metrics are created on the first access and live as long as the registry, so references to
+/// them can be obtained once and used without any lookups afterwards.
+///
+/// \threadsafe
+class registry_t {
+    mutable std::mutex mutex;
+
+    std::map<std::string, std::unique_ptr<counter_t>> counters;
+    std::map<std::string, std::unique_ptr<gauge_t>> gauges;
+    std::map<std::string, std::unique_ptr<histogram_t>> histograms;
+
+public:
+    registry_t();
+    ~registry_t();
+
+    registry_t(const registry_t&) = delete;
+    registry_t& operator=(const registry_t&) = delete;
+
+    /// Returns the process-wide registry, which is used by event loops not bound to any service
+    /// manager or worker.
+    static
+    auto
+    global() -> registry_t&;
+
+    auto counter(const std::string& name) -> counter_t&;
+    auto gauge(const std::string& name) -> gauge_t&;
+    auto histogram(const std::string& name) -> histogram_t&;
+
+    auto snapshot() const -> metrics_snapshot_t;
+};
+
+}  // namespace metrics
+}  // namespace detail
+}  // namespace framework
+}  // namespace cocaine
@@ -16,18 +16,24 @@
 
 #pragma once
 
+#include <chrono>
+#include <memory>
 #include <unordered_map>
 
 #include <boost/asio/ip/tcp.hpp>
 
 #include "cocaine/framework/forwards.hpp"
 
+#include "cocaine/framework/detail/metrics.hpp"
+
 namespace cocaine {
 
 namespace framework {
 
 namespace detail {
 
+class locations_t;
+
 /*!
  * \reentrant
  */
@@ -42,7 +48,7 @@ public:
 
 private:
     scheduler_t& scheduler;
-    std::vector<endpoint_type> endpoints_;
+    std::shared_ptr<locations_t> locations;
 
 public:
     /*!
@@ -50,6 +56,9 @@ public:
      */
     explicit resolver_t(scheduler_t& scheduler);
 
+    /// Constructs a resolver, which waits for the given Locator locations before each resolving.
+    resolver_t(scheduler_t& scheduler, std::shared_ptr<locations_t> locations);
+
     ~resolver_t();
 
     std::vector<endpoint_type> endpoints() const;
@@ -72,13 +81,26 @@ private:
     std::unordered_map<std::string, std::deque<task<result_type>::promise_type>> inprogress;
     std::mutex mutex;
 
+    struct metrics_t {
+        /// Number of resolve requests, including coalesced ones.
+        detail::metrics::counter_t& requests;
+        /// Number of requests joined to already in-progress resolving.
+        detail::metrics::counter_t& coalesced;
+        detail::metrics::counter_t& errors;
+        detail::metrics::histogram_t& latency;
+
+        explicit metrics_t(detail::metrics::registry_t& registry);
+    } metrics;
+
 public:
     serialized_resolver_t(std::vector<endpoint_type> endpoints, scheduler_t& scheduler);
+    serialized_resolver_t(std::shared_ptr<locations_t> locations, scheduler_t& scheduler);
 
     auto resolve(std::string name) -> task<result_type>::future_type;
 
     result_type
-    notify_all(task<result_type>::future_move_type future, std::string name);
+    notify_all(task<result_type>::future_move_type future, std::string name,
+               std::chrono::steady_clock::time_point start);
 };
 
 } // namespace detail
@@ -0,0 +1,145 @@
+/*
+    Copyright (c) 2015 Evgeny Safronov <division494@gmail.com>
+    Copyright (c) 2011-2015 Other contributors as noted in the AUTHORS file.
+    This file is part of Cocaine.
+    Cocaine is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+    Cocaine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU Lesser General Public License for more details.
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace cocaine { namespace framework { namespace detail {
+
+/// Pool of equally sized memory blocks, which recycles released blocks instead of returning them
+/// to the global allocator.
+///
+/// The block size is fixed by the first allocation. Allocations of other sizes, as well as blocks
+/// released while the pool is full, are passed to the global allocator.
+///
+/// \internal
+/// \threadsafe
+class slab_t {
+    std::mutex mutex;
+    std::vector<void*> blocks;
+    std::size_t block_size;
+    const std::size_t capacity;
+
+public:
+    /// Constructs a pool, keeping at most the given number of released blocks.
+    explicit
+    slab_t(std::size_t capacity = 1024) :
+        block_size(0),
+        capacity(capacity)
+    {
+        blocks.reserve(capacity);
+    }
+
+    slab_t(const slab_t&) = delete;
+    slab_t& operator=(const slab_t&) = delete;
+
+    ~slab_t() {
+        for (auto block : blocks) {
+            ::operator delete(block);
+        }
+    }
+
+    void*
+    allocate(std::size_t size) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (block_size == 0) {
+                block_size = size;
+            }
+
+            if (size == block_size && !blocks.empty()) {
+                auto block = blocks.back();
+                blocks.pop_back();
+                return block;
+            }
+        }
+
+        return ::operator new(size);
+    }
+
+    void
+    deallocate(void* block, std::size_t size) noexcept {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (size == block_size && blocks.size() < capacity) {
+                blocks.push_back(block);
+                return;
+            }
+        }
+
+        ::operator delete(block);
+    }
+};
+
+/// Allocator, which takes memory from the given slab, keeping it alive until all allocated memory
+/// is released.
+///
+/// \internal
+template<class T>
+class slab_allocator_t {
+    template<class> friend class slab_allocator_t;
+
+    std::shared_ptr<slab_t> slab;
+
+public:
+    typedef T value_type;
+
+    explicit
+    slab_allocator_t(std::shared_ptr<slab_t> slab) :
+        slab(std::move(slab))
+    {}
+
+    template<class U>
+    slab_allocator_t(const slab_allocator_t<U>& other) :
+        slab(other.slab)
+    {}
+
+    template<class U>
+    struct rebind {
+        typedef slab_allocator_t<U> other;
+    };
+
+    T*
+    allocate(std::size_t n) {
+        return static_cast<T*>(slab->allocate(n * sizeof(T)));
+    }
+
+    void
+    deallocate(T* ptr, std::size_t n) noexcept {
+        slab->deallocate(ptr, n * sizeof(T));
+    }
+
+    template<class U>
+    bool
+    operator==(const slab_allocator_t<U>& other) const noexcept {
+        return slab == other.slab;
+    }
+
+    template<class U>
+    bool
+    operator!=(const slab_allocator_t<U>& other) const noexcept {
+        return !(*this == other);
+    }
+};
+
+}}} // namespace cocaine::framework::detail
@@ -16,10 +16,14 @@
 
 #pragma once
 
+#include <chrono>
+#include <functional>
+
 #include <boost/optional.hpp>
 #include <boost/thread/thread.hpp>
 
 #include "cocaine/framework/detail/loop.hpp"
+#include "cocaine/framework/detail/metrics.hpp"
 #include "cocaine/framework/detail/runnable.hpp"
 
 namespace cocaine {
@@ -40,16 +44,30 @@ class executor_t {
     boost::optional<detail::loop_t::work> work;
     boost::thread_group pool;
 
+    /// Number of tasks posted, but not yet started.
+    metrics::gauge_t& queue;
+    /// Time tasks spend in the queue, in microseconds.
+    metrics::histogram_t& wait;
+
 public:
     executor_t() :
-        work(boost::optional<detail::loop_t::work>(detail::loop_t::work(loop)))
+        executor_t(metrics::registry_t::global())
+    {}
+
+    explicit executor_t(metrics::registry_t& registry) :
+        work(boost::optional<detail::loop_t::work>(detail::loop_t::work(loop))),
+        queue(registry.gauge("executor.queue")),
+        wait(registry.histogram("executor.wait"))
     {
         auto threads = boost::thread::hardware_concurrency();
         start(threads != 0 ? threads : 1);
     }
 
-    explicit executor_t(unsigned int threads) :
-        work(boost::optional<detail::loop_t::work>(detail::loop_t::work(loop)))
+    explicit executor_t(unsigned int threads,
+                        metrics::registry_t& registry = metrics::registry_t::global()) :
+        work(boost::optional<detail::loop_t::work>(detail::loop_t::work(loop))),
+        queue(registry.gauge("executor.queue")),
+        wait(registry.histogram("executor.wait"))
     {
         if (threads == 0) {
             throw std::invalid_argument("thread count must be a positive number");
@@ -64,10 +82,17 @@ public:
     }
 
     void operator()(std::function<void()> fn) {
-        loop.post(std::move(fn));
+        queue.inc();
+        loop.post(std::bind(&executor_t::execute, this, std::move(fn), std::chrono::steady_clock::now()));
     }
 
 private:
+    void execute(const std::function<void()>& fn, std::chrono::steady_clock::time_point start) {
+        queue.dec();
+        wait.record_since(start);
+        fn();
+    }
+
     void start(unsigned int threads) {
         for (unsigned int i = 0; i < threads; ++i) {
             pool.create_thread(named_runnable<loop_t>("[CF::W]", loop));
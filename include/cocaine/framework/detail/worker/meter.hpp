@@ -0,0 +1,127 @@
+/*
+    Copyright (c) 2015 Evgeny Safronov <division494@gmail.com>
+    Copyright (c) 2011-2015 Other contributors as noted in the AUTHORS file.
+    This file is part of Cocaine.
+    Cocaine is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+    Cocaine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU Lesser General Public License for more details.
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+#include "cocaine/framework/detail/metrics.hpp"
+
+namespace cocaine {
+
+namespace framework {
+
+namespace detail {
+
+namespace worker {
+
+/// Metrics of a single event, registered under the given prefix.
+///
+/// All histograms measure time elapsed since the invocation has been received, in microseconds.
+///
+/// \internal
+struct event_metrics_t {
+    metrics::counter_t& invocations;
+    metrics::counter_t& errors;
+    metrics::gauge_t& inflight;
+
+    /// Time spent in the executor queue before the handler starts.
+    metrics::histogram_t& wait;
+    /// Time until the first chunk is written.
+    metrics::histogram_t& first_chunk;
+    /// Time until the channel is closed, either normally or with an error.
+    metrics::histogram_t& close;
+
+    event_metrics_t(metrics::registry_t& registry, const std::string& prefix) :
+        invocations(registry.counter(prefix + ".invocations")),
+        errors(registry.counter(prefix + ".errors")),
+        inflight(registry.gauge(prefix + ".inflight")),
+        wait(registry.histogram(prefix + ".wait")),
+        first_chunk(registry.histogram(prefix + ".first_chunk")),
+        close(registry.histogram(prefix + ".close"))
+    {}
+};
+
+/// Measures a single invocation, from its receipt until the channel is closed.
+///
+/// Shared between the handler task and all incarnations of the invocation sender, so the
+/// invocation is considered in-flight until the last of them is destroyed.
+///
+/// \internal
+class meter_t {
+    event_metrics_t& metrics;
+    const std::chrono::steady_clock::time_point birth;
+
+    std::atomic<bool> written;
+    std::atomic<bool> closed;
+
+public:
+    explicit meter_t(event_metrics_t& metrics) :
+        metrics(metrics),
+        birth(std::chrono::steady_clock::now()),
+        written(false),
+        closed(false)
+    {
+        metrics.invocations.inc();
+        metrics.inflight.inc();
+    }
+
+    meter_t(const meter_t&) = delete;
+    meter_t& operator=(const meter_t&) = delete;
+
+    ~meter_t() {
+        metrics.inflight.dec();
+    }
+
+    /// Called by the executor right before the handler starts.
+    void
+    on_start() noexcept {
+        metrics.wait.record_since(birth);
+    }
+
+    /// Called on each chunk written. Only the first one is recorded.
+    void
+    on_write() noexcept {
+        if (!written.exchange(true, std::memory_order_relaxed)) {
+            metrics.first_chunk.record_since(birth);
+        }
+    }
+
+    /// Called when the channel is closed normally.
+    void
+    on_close() noexcept {
+        if (!closed.exchange(true, std::memory_order_relaxed)) {
+            metrics.close.record_since(birth);
+        }
+    }
+
+    /// Called when the channel is closed with an error.
+    void
+    on_error() noexcept {
+        metrics.errors.inc();
+        on_close();
+    }
+};
+
+} // namespace worker
+
+} // namespace detail
+
+} // namespace framework
+
+} // namespace cocaine
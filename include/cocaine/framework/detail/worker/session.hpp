@@ -20,6 +20,8 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <string>
+#include <unordered_map>
 
 #include <asio/local/stream_protocol.hpp>
 
@@ -31,9 +33,14 @@
 
 #include "cocaine/framework/encoder.hpp"
 #include "cocaine/framework/message.hpp"
+#include "cocaine/framework/trace/sampling.hpp"
 #include "cocaine/framework/worker/dispatch.hpp"
 
 #include "cocaine/framework/detail/decoder.hpp"
+#include "cocaine/framework/detail/metrics.hpp"
+#include "cocaine/framework/detail/slab.hpp"
+#include "cocaine/framework/detail/writer.hpp"
+#include "cocaine/framework/detail/worker/meter.hpp"
 
 namespace cocaine {
 
@@ -61,21 +68,58 @@ private:
     /// Userspace event handler executor.
     executor_t executor;
 
+    /// Decides whether an incoming traced request should actually be traced.
+    const trace::sampler_t sampler;
+
     detail::decoder_t::message_type message;
 
     /// Underlying transport.
     typedef io::transport<protocol_type, io::encoder_t, detail::decoder_t> transport_type;
     synchronized<std::unique_ptr<transport_type>> transport;
 
+    /// Write queue of the transport socket. All writes go through it instead of the transport
+    /// writer.
+    typedef detail::writer_t<protocol_type::socket> writer_type;
+    synchronized<std::shared_ptr<writer_type>> writer;
+
     std::atomic<std::uint64_t> counter;
-    synchronized<std::map<std::uint64_t, std::shared_ptr<shared_state_t>>> channels;
+    /// Channels are owned by their sender and receiver handles only, so they are referred weakly.
+    synchronized<std::map<std::uint64_t, std::weak_ptr<shared_state_t>>> channels;
+    /// Memory of released channels, reused by new ones.
+    std::shared_ptr<detail::slab_t> slab;
+    /// Memory of released receiver handle counters, reused by new channels.
+    std::shared_ptr<detail::slab_t> receivers;
 
     /// Health.
     asio::deadline_timer heartbeat_timer;
     asio::deadline_timer disown_timer;
 
+    struct metrics_t {
+        detail::metrics::gauge_t& channels;
+        detail::metrics::counter_t& invokes;
+        detail::metrics::counter_t& frames_read;
+        detail::metrics::counter_t& bytes_read;
+        detail::metrics::counter_t& frames_written;
+        detail::metrics::counter_t& bytes_written;
+        detail::metrics::histogram_t& write_latency;
+
+        detail::metrics::registry_t& registry;
+        /// Metrics of events with no handler registered, which are accounted together to avoid
+        /// unbounded number of metrics.
+        detail::worker::event_metrics_t fallback;
+        /// Per-event metrics cache, accessed from the event loop thread only.
+        std::unordered_map<std::string, std::unique_ptr<detail::worker::event_metrics_t>> events;
+
+        explicit metrics_t(detail::metrics::registry_t& registry);
+
+        /// Returns metrics of the given event, registering them on the first call.
+        auto
+        event(const std::string& name) -> detail::worker::event_metrics_t&;
+    } metrics;
+
 public:
-    worker_session_t(dispatch_t& dispatch, scheduler_t& scheduler, executor_t executor);
+    worker_session_t(dispatch_t& dispatch, scheduler_t& scheduler, executor_t executor,
+                     trace::sampler_t sampler = trace::sampler_t());
 
     /// Performs synchronous connection to the given endpoint.
     void
@@ -94,6 +138,12 @@ public:
     future<void>
     push(io::encoder_t::message_type&& message);
 
+    /// Pushes the given message followed by the blob, which is written without copying.
+    ///
+    /// \pre the message must end with a raw header, announcing the blob size.
+    future<void>
+    push(io::encoder_t::message_type&& message, blob_t blob);
+
     void
     revoke(std::uint64_t span);
 
@@ -137,7 +187,7 @@ private:
     void process_handshake();
     void process_heartbeat();
     void process_terminate();
-    void process_invoke(std::map<std::uint64_t, std::shared_ptr<shared_state_t>>& channels);
+    void process_invoke(std::map<std::uint64_t, std::weak_ptr<shared_state_t>>& channels);
 };
 
 }
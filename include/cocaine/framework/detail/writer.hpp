@@ -0,0 +1,144 @@
+/*
+    Copyright (c) 2015 Evgeny Safronov <division494@gmail.com>
+    Copyright (c) 2011-2015 Other contributors as noted in the AUTHORS file.
+    This file is part of Cocaine.
+    Cocaine is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+    Cocaine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU Lesser General Public License for more details.
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <vector>
+
+#include <asio/buffer.hpp>
+#include <asio/write.hpp>
+
+#include <cocaine/rpc/asio/encoder.hpp>
+
+#include "cocaine/framework/encoder.hpp"
+
+namespace cocaine { namespace framework { namespace detail {
+
+/// Gathered write queue over a stream socket.
+///
+/// Each queued message consists of an encoded head and an optional blob, which is sent right after
+/// the head without being copied. Messages queued while a write operation is in progress are sent
+/// together in the next one as a single scatter-gather write.
+///
+/// \note all writes of the socket must go through the same writer, otherwise messages may be
+/// interleaved.
+///
+/// \internal
+/// \threadsafe
+template<class Socket>
+class writer_t : public std::enable_shared_from_this<writer_t<Socket>> {
+public:
+    typedef Socket socket_type;
+    typedef std::function<void(const std::error_code&)> handler_type;
+
+private:
+    struct entry_t {
+        io::encoder_t::message_type head;
+        blob_t blob;
+        handler_type handler;
+    };
+
+    const std::shared_ptr<socket_type> socket;
+
+    std::mutex mutex;
+    std::deque<entry_t> pending;
+    /// Messages being written, untouched until the write operation completes.
+    std::vector<entry_t> inflight;
+    bool writing;
+
+public:
+    explicit
+    writer_t(std::shared_ptr<socket_type> socket) :
+        socket(std::move(socket)),
+        writing(false)
+    {}
+
+    /// Queues the given message for writing. The handler is called from the event loop thread after
+    /// the message is written or a socket error occurs.
+    void
+    write(io::encoder_t::message_type head, blob_t blob, handler_type handler) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        pending.push_back(entry_t{std::move(head), std::move(blob), std::move(handler)});
+
+        if (!writing) {
+            flush();
+        }
+    }
+
+private:
+    /// \pre the mutex is locked and there is no write operation in progress.
+    void
+    flush() {
+        writing = true;
+
+        inflight.reserve(pending.size());
+        for (auto& entry : pending) {
+            inflight.push_back(std::move(entry));
+        }
+        pending.clear();
+
+        std::vector<asio::const_buffer> buffers;
+        buffers.reserve(inflight.size() * 2);
+        for (const auto& entry : inflight) {
+            if (entry.head.size() > 0) {
+                buffers.push_back(asio::buffer(entry.head.data(), entry.head.size()));
+            }
+
+            if (entry.blob.size() > 0) {
+                buffers.push_back(asio::buffer(entry.blob.data(), entry.blob.size()));
+            }
+        }
+
+        asio::async_write(*socket, buffers, std::bind(
+            &writer_t::on_write, this->shared_from_this(), std::placeholders::_1
+        ));
+    }
+
+    void
+    on_write(const std::error_code& ec) {
+        std::vector<entry_t> done;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done.swap(inflight);
+
+            if (ec) {
+                // The stream is broken, so there is no point in writing queued messages.
+                for (auto& entry : pending) {
+                    done.push_back(std::move(entry));
+                }
+                pending.clear();
+                writing = false;
+            } else if (pending.empty()) {
+                writing = false;
+            } else {
+                flush();
+            }
+        }
+
+        for (const auto& entry : done) {
+            entry.handler(ec);
+        }
+    }
+};
+
+}}} // namespace cocaine::framework::detail
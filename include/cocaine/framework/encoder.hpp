@@ -20,7 +20,16 @@
 
 #pragma once
 
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <boost/utility/string_ref.hpp>
+
 #include <cocaine/rpc/asio/encoder.hpp>
+#include <cocaine/utility.hpp>
 
 namespace cocaine { namespace framework {
 
@@ -33,4 +42,150 @@ encode(std::uint64_t span, Args&... args) {
     return io::encoded<Event>(span, std::forward<Args>(args)...);
 }
 
+/// Represents several messages of the same channel encoded into a single buffer, which allows to
+/// send all of them using a single write operation.
+class encoded_frames_t : public io::encoder_t::message_type {
+    std::uint64_t span;
+
+public:
+    explicit encoded_frames_t(std::uint64_t span) :
+        span(span)
+    {}
+
+    /// Encodes the given event with its arguments and appends it to the buffer.
+    template<class Event, class... Args>
+    void
+    append(Args&&... args) {
+        msgpack::packer<buffer_type> packer(buffer);
+        packer.pack_array(3);
+        packer << span;
+        packer << io::event_traits<Event>::id;
+
+        io::type_traits<
+            typename io::event_traits<Event>::argument_type
+        >::pack(packer, std::forward<Args>(args)...);
+    }
+
+    /// Appends the given event, which has a single raw argument, packing the data directly into the
+    /// buffer without constructing a string.
+    template<class Event>
+    void
+    append_raw(boost::string_ref data) {
+        msgpack::packer<buffer_type> packer(buffer);
+        packer.pack_array(3);
+        packer << span;
+        packer << io::event_traits<Event>::id;
+        packer.pack_array(1);
+        packer.pack_raw(data.size());
+        packer.pack_raw_body(data.data(), data.size());
+    }
+
+    /// Appends the given event, which has a single raw argument, up to the raw body, which must be
+    /// sent right after this buffer.
+    template<class Event>
+    void
+    append_raw_header(std::size_t size) {
+        msgpack::packer<buffer_type> packer(buffer);
+        packer.pack_array(3);
+        packer << span;
+        packer << io::event_traits<Event>::id;
+        packer.pack_array(1);
+        packer.pack_raw(size);
+    }
+};
+
+/// Represents an immutable binary payload, which is sent as is without copying.
+///
+/// The blob shares the ownership of the underlying storage, keeping it alive until the payload is
+/// written to the socket.
+class blob_t {
+    std::shared_ptr<const void> owner;
+    const char* data_;
+    std::size_t size_;
+
+public:
+    /// Constructs an empty blob.
+    blob_t() :
+        data_(nullptr),
+        size_(0)
+    {}
+
+    /// Constructs a blob, pointing to the whole given buffer, which is either std::string or
+    /// std::vector<char>, possibly const, so `std::make_shared<std::string>(...)` converts as is.
+    template<class T, class = typename std::enable_if<
+        std::is_same<typename std::remove_const<T>::type, std::string>::value ||
+        std::is_same<typename std::remove_const<T>::type, std::vector<char>>::value
+    >::type>
+    blob_t(std::shared_ptr<T> buffer) :
+        owner(buffer),
+        data_(buffer->data()),
+        size_(buffer->size())
+    {}
+
+    /// Constructs a blob, pointing to the given memory region, which is owned by the given object.
+    template<class T>
+    blob_t(std::shared_ptr<T> owner, const char* data, std::size_t size) :
+        owner(std::move(owner)),
+        data_(data),
+        size_(size)
+    {}
+
+    auto
+    data() const noexcept -> const char* {
+        return data_;
+    }
+
+    auto
+    size() const noexcept -> std::size_t {
+        return size_;
+    }
+};
+
+/// Represents invocation messages of several consecutive channels encoded into a single buffer,
+/// which allows to open all of them using a single write operation.
+class encoded_batch_t : public io::encoder_t::message_type {
+public:
+    /// Encodes the given event for the given channel and appends it to the buffer.
+    template<class Event, class... Args>
+    void
+    append(std::uint64_t span, Args&&... args) {
+        msgpack::packer<buffer_type> packer(buffer);
+        packer.pack_array(3);
+        packer << span;
+        packer << io::event_traits<Event>::id;
+
+        io::type_traits<
+            typename io::event_traits<Event>::argument_type
+        >::pack(packer, std::forward<Args>(args)...);
+    }
+
+    /// Encodes the given event with arguments unpacked from the tuple.
+    template<class Event, class... Args>
+    void
+    append_tuple(std::uint64_t span, const std::tuple<Args...>& args) {
+        append_tuple<Event>(span, args, typename make_index_sequence<sizeof...(Args)>::type());
+    }
+
+private:
+    template<class Event, class... Args, size_t... Index>
+    void
+    append_tuple(std::uint64_t span, const std::tuple<Args...>& args, index_sequence<Index...>) {
+        append<Event>(span, std::get<Index>(args)...);
+    }
+};
+
+/// Encodes invocations of the given event with the given arguments, assigning consecutive channel
+/// ids starting from the given span.
+template<class Event, class... Args>
+static
+io::encoder_t::message_type
+encode_many(std::uint64_t span, const std::vector<std::tuple<Args...>>& args) {
+    encoded_batch_t batch;
+    for (const auto& tuple : args) {
+        batch.append_tuple<Event>(span++, tuple);
+    }
+
+    return std::move(batch);
+}
+
 }}
@@ -35,7 +35,11 @@ enum service_errors {
     /// The specified service is not available.
     service_not_found = 1,
     /// The service provides API with version different than required.
-    version_mismatch
+    version_mismatch,
+    /// The service was not connected in time while the request has been waiting for it.
+    connect_timeout,
+    /// Too many requests are waiting for the service to be connected.
+    connect_queue_overflow
 };
 
 /// Response specific error codes.
@@ -63,6 +63,8 @@ namespace cocaine {
 
         typedef session<basic_session_t> session_t;
 
+        struct reconnect_policy_t;
+
         class basic_service_t;
 
         template<class T>
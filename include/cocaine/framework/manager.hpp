@@ -16,12 +16,16 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "cocaine/framework/forwards.hpp"
+#include "cocaine/framework/metrics.hpp"
 #include "cocaine/framework/session.hpp"
+#include "cocaine/framework/trace_logger.hpp"
 
 namespace cocaine { namespace io {
     struct log_tag;
@@ -53,8 +57,11 @@ public:
     /// Constructs a service manager using the given entry points and number of worker threads.
     service_manager_t(std::vector<endpoint_type> entries, unsigned int threads);
 
-    /// Constructs a new service manager after performing a blocking DNS resolving of a given
-    /// locator endpoints.
+    /// Constructs a new service manager with locator endpoints given as host names.
+    ///
+    /// Host names are resolved asynchronously, without blocking the manager threads, when the
+    /// Locator is required for the first time, and periodically refreshed after that. Hosts,
+    /// which fail to resolve, are skipped.
     ///
     /// \param entries locator endpoints as a list of FQDN:port pairs.
     /// \param threads number of worker threads.
@@ -62,15 +69,77 @@ public:
 
     ~service_manager_t();
 
+    /// Returns locator endpoints, waiting for their host names to be resolved if required.
+    ///
+    /// \warning this call blocks until resolving completes, which requires the manager threads.
+    /// Calling it from a manager thread, for example from a future callback, may deadlock, unless
+    /// host names are already resolved.
+    ///
+    /// \throws std::system_error if none of host names can be resolved.
     std::vector<endpoint_type>
     endpoints() const;
 
+    /// Returns a handle of the service with the given name.
+    ///
+    /// Services are interned by their name and protocol version, so all handles of the same service
+    /// share a single resolver and session, and therefore a single connection. A service is kept for
+    /// the idle timeout after its last handle is released to be reused by handles created later,
+    /// and is evicted, closing its connection, after that.
+    ///
+    /// Because of sharing, destroying a handle does not close the connection, and settings of the
+    /// session, like \sa basic_service_t::hard_shutdown, are shared by all handles.
+    ///
+    /// \threadsafe
     template<class T>
     service<T>
     create(std::string name) {
-        return service<T>(logger(), std::move(name), endpoints(), next());
+        return service<T>(intern(std::move(name), io::protocol<T>::version::value));
     }
 
+    /// Resolves and connects the services with the given names in parallel, so the first
+    /// invocations of them do not pay for it.
+    ///
+    /// Services are warmed up with the protocol version reported by the Locator, so handles created
+    /// later for the same name and version share the already established connection.
+    ///
+    /// \returns a future, which is set after all services are either connected or failed. It holds
+    /// the error of the first failed service, if any.
+    ///
+    /// \warning the manager must outlive the returned future completion.
+    /// \threadsafe
+    auto
+    warmup(std::vector<std::string> names) -> task<void>::future_type;
+
+    /// Returns a snapshot of metrics collected by all services created by this manager.
+    ///
+    /// \threadsafe
+    auto
+    metrics() const -> metrics_snapshot_t;
+
+    /// Returns the time an interned service without handles is kept before being evicted.
+    ///
+    /// \threadsafe
+    auto
+    idle_timeout() const -> std::chrono::milliseconds;
+
+    /// Sets the time an interned service without handles is kept before being evicted, which is a
+    /// minute by default.
+    ///
+    /// \threadsafe
+    void
+    idle_timeout(std::chrono::milliseconds timeout);
+
+    /// Returns the policy services created by this manager are connected with.
+    reconnect_policy_t
+    reconnect_policy() const;
+
+    /// Sets the policy services are connected with.
+    ///
+    /// The policy applies to services created after this call, while already interned services
+    /// keep the policy they were created with until evicted.
+    void
+    reconnect_policy(reconnect_policy_t policy);
+
     /// Returns a shared pointer to the associated logger service.
     std::shared_ptr<service<io::log_tag>>
     logger() const;
@@ -92,6 +161,15 @@ private:
 
     scheduler_t&
     next();
+
+    /// Returns the trace logger shared by all services created by this manager.
+    internal_logger_t
+    trace_logger() const;
+
+    /// Returns a new handle of the service with the given name and version, creating the service
+    /// if there is no such one.
+    basic_service_t
+    intern(std::string name, unsigned int version);
 };
 
 }} // namespace cocaine::framework
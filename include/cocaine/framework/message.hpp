@@ -32,6 +32,13 @@ namespace msgpack { struct object; }
 namespace cocaine {
 namespace framework {
 
+/// Tracing information extracted from the well-known message headers.
+struct trace_headers_t {
+    std::uint64_t trace_id;
+    std::uint64_t span_id;
+    std::uint64_t parent_id;
+};
+
 /// The decoded message class represents movable unpacked MessagePack payload with internal storage.
 class decoded_message {
     class inner_t;
@@ -63,11 +70,25 @@ public:
     /// Returns the message type.
     auto type() const -> std::uint64_t;
 
+    /// Returns the size of the encoded frame in bytes.
+    auto size() const noexcept -> std::size_t;
+
     /// Returns the object representation of message arguments.
     auto args() const -> const msgpack::object&;
 
     auto meta() const noexcept -> const std::vector<hpack::header_t>&;
 
+    /// Moves headers out of this message, leaving it with no headers.
+    ///
+    /// Tracing information is extracted before, so it remains available.
+    auto take_meta() noexcept -> std::vector<hpack::header_t>;
+
+    /// Returns tracing information, which is extracted from headers on the first call only, so
+    /// messages, whose trace is never asked for, don't pay for scanning headers.
+    ///
+    /// Contains none value if any of trace, span or parent id headers is missing or malformed.
+    auto trace() const noexcept -> const boost::optional<trace_headers_t>&;
+
     template<class Header>
     boost::optional<hpack::header_t>
     get_header() const {
@@ -0,0 +1,68 @@
+/*
+    Copyright (c) 2015 Evgeny Safronov <division494@gmail.com>
+    Copyright (c) 2011-2015 Other contributors as noted in the AUTHORS file.
+    This file is part of Cocaine.
+    Cocaine is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+    Cocaine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU Lesser General Public License for more details.
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cocaine {
+namespace framework {
+
+/// Point-in-time snapshot of a histogram.
+///
+/// Latencies are measured in microseconds, sizes in bytes.
+struct histogram_snapshot_t {
+    /// Total number of recorded values.
+    std::uint64_t count;
+
+    /// Sum of all recorded values.
+    std::uint64_t sum;
+
+    /// Non-empty buckets as pairs of the bucket upper bound and the number of values in it,
+    /// ordered by the bound.
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> buckets;
+
+    /// Returns the approximate value at the given quantile, which must be in [0.0, 1.0] range.
+    ///
+    /// The relative error is bounded by the histogram precision, which is about 6%.
+    auto quantile(double q) const -> std::uint64_t;
+
+    /// Returns the arithmetic mean of all recorded values.
+    auto mean() const -> double;
+
+    /// Returns the approximate maximum recorded value.
+    auto max() const -> std::uint64_t;
+};
+
+/// Point-in-time snapshot of all metrics of a service manager or a worker.
+///
+/// Counters only grow, gauges represent current values, like the number of in-flight channels.
+struct metrics_snapshot_t {
+    std::map<std::string, std::uint64_t> counters;
+    std::map<std::string, std::int64_t> gauges;
+    std::map<std::string, histogram_snapshot_t> histograms;
+
+    /// Merges the other snapshot into this one, replacing metrics with the same names.
+    void
+    merge(const metrics_snapshot_t& other);
+};
+
+}  // namespace framework
+}  // namespace cocaine
@@ -47,12 +47,19 @@ private:
     std::uint64_t id;
     std::shared_ptr<session_type> session;
     std::shared_ptr<shared_state_t> state;
+    bool revoked;
 
 public:
     basic_receiver_t(std::uint64_t id, std::shared_ptr<session_type> session, std::shared_ptr<shared_state_t> state);
 
     ~basic_receiver_t();
 
+    /// Revokes the channel from the session, so its further messages are dropped.
+    ///
+    /// Called after the last receiver handle is released, which may happen long before the
+    /// receiver itself is destroyed. Does nothing if the channel is already revoked.
+    void revoke();
+
     /// Returns a future with a decoded message received from the session.
     ///
     /// This future may throw std::system_error on any network failure.
@@ -69,9 +76,14 @@ public:
 
 private:
     typedef typename detail::result_of<receiver<T, session_type>>::type result_type;
-    typedef std::function<result_type(std::shared_ptr<basic_receiver_t<session_type>>, const msgpack::object&)> unpacker_type;
+    typedef result_type(*unpacker_type)(std::shared_ptr<basic_receiver_t<session_type>>, const msgpack::object&);
+    typedef std::array<
+        unpacker_type,
+        boost::mpl::size<typename io::protocol<T>::messages>::value
+    > unpackers_type;
 
-    static const std::unordered_map<std::uint64_t, unpacker_type> unpackers;
+    /// Unpackers indexed by message type id.
+    static const unpackers_type unpackers;
 
     std::shared_ptr<basic_receiver_t<session_type>> d;
 
@@ -125,7 +137,7 @@ public:
 
         trace_t::restore_scope_t scope(d->get_trace());
         return future
-            .then(trace_t::bind(&receiver::convert, std::placeholders::_1, d));
+            .then(trace::bind(&receiver::convert, std::placeholders::_1, d));
     }
 
 private:
@@ -135,13 +147,11 @@ private:
         const auto message = future.get();
         const auto id = message.type();
 
-        auto it = unpackers.find(id);
-
-        if (it == std::end(unpackers)) {
+        if (id >= unpackers.size()) {
             throw std::runtime_error("invalid protocol");
         }
 
-        auto result = it->second(std::move(d), message.args());
+        auto result = unpackers[id](std::move(d), message.args());
         return from_receiver<T, Session>::transform(result);
     }
 };
@@ -169,9 +179,13 @@ public:
 
 private:
     typedef typename detail::variant_of<tag_type>::type result_type;
-    typedef std::function<result_type(const msgpack::object&)> unpacker_type;
-    typedef std::unordered_map<std::uint64_t, unpacker_type> unpackers_type;
+    typedef result_type(*unpacker_type)(const msgpack::object&);
+    typedef std::array<
+        unpacker_type,
+        boost::mpl::size<typename io::protocol<tag_type>::messages>::value
+    > unpackers_type;
 
+    /// Unpackers indexed by message type id.
     static const unpackers_type unpackers;
 
     std::shared_ptr<basic_receiver_t<session_type>> d;
@@ -198,7 +212,7 @@ public:
     auto recv() -> typename task<typename from_receiver<tag_type, Session>::result_type>::future_type {
         auto future = d->recv();
         return future
-            .then(trace_t::bind(&receiver::convert, std::placeholders::_1, d));
+            .then(trace::bind(&receiver::convert, std::placeholders::_1, d));
     }
 
 private:
@@ -208,13 +222,11 @@ private:
         const auto message = future.get();
         const auto id = message.type();
 
-        auto it = unpackers.find(id);
-
-        if (it == std::end(unpackers)) {
+        if (id >= unpackers.size()) {
             throw std::runtime_error("invalid protocol");
         }
 
-        auto payload = it->second(message.args());
+        auto payload = unpackers[id](message.args());
         return from_receiver<tag_type, Session>::transform(payload);
     }
 };
@@ -233,22 +245,20 @@ public:
 };
 
 // Static unpackers variables initialization.
+//
+// Both arrays are built by constexpr functions, so they are constant-initialized without any
+// dynamic initialization or allocation.
 template<class T, class Session>
-const std::unordered_map<
-    std::uint64_t,
-    typename receiver<T, Session>::unpacker_type
-> receiver<T, Session>::unpackers =
-    detail::to_map<
+const typename receiver<T, Session>::unpackers_type receiver<T, Session>::unpackers =
+    detail::to_array<
         typename receiver<T, Session>::result_type::types,
         detail::unpacker_factory<Session, typename receiver<T, Session>::unpacker_type>
     >::make();
 
 template<class T, class Session>
-const std::unordered_map<
-    std::uint64_t,
-    typename receiver<io::streaming_tag<T>, Session>::unpacker_type
-> receiver<io::streaming_tag<T>, Session>::unpackers =
-    detail::to_map<
+const typename receiver<io::streaming_tag<T>, Session>::unpackers_type
+receiver<io::streaming_tag<T>, Session>::unpackers =
+    detail::to_array<
         typename receiver<io::streaming_tag<T>, Session>::result_type::types,
         detail::unpacker_factory<Session, typename receiver<io::streaming_tag<T>, Session>::unpacker_type>
     >::make();
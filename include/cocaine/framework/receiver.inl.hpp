@@ -19,7 +19,6 @@
 #include <array>
 #include <cstdint>
 #include <tuple>
-#include <unordered_map>
 
 #include <boost/mpl/at.hpp>
 #include <boost/mpl/front.hpp>
@@ -42,16 +41,19 @@ namespace cocaine { namespace framework {
 
 namespace detail {
 
-/// Transforms a typelist sequence into an unordered map using the given metafunction.
+/// Transforms a typelist sequence into a constant array using the given metafunction.
+///
+/// The element index corresponds to the type position in the sequence, which is the same as the
+/// message id for protocol message lists.
 ///
 /// \internal
 template<class Sequence, class F>
-struct to_map {
+struct to_array {
     typedef Sequence sequence_type;
     typedef typename F::result_type value_type;
     static constexpr std::size_t size = boost::mpl::size<sequence_type>::value;
 
-    typedef std::unordered_map<std::uint64_t, value_type> result_type;
+    typedef std::array<value_type, size> result_type;
 
 private:
     template<class IndexSequence>
@@ -59,13 +61,12 @@ private:
 
     template<size_t... Index>
     struct helper<index_sequence<Index...>> {
-        static inline
+        static constexpr
         result_type
         apply() {
             return result_type {{
-                Index,
-                F::template apply<typename boost::mpl::at<sequence_type, boost::mpl::int_<Index>>::type>()
-            }...};
+                F::template apply<typename boost::mpl::at<sequence_type, boost::mpl::int_<Index>>::type>()...
+            }};
         }
     };
 
@@ -277,16 +278,50 @@ struct unpacked_result<std::tuple<Args...>> {
 
 /// The metafunction to be used to fill static array with unpackers.
 ///
+/// Produces plain function pointers, which call the corresponding unpacker directly, depending on
+/// the unpacker signature required.
+///
 /// \internal
+template<class Session, class Unpacker>
+struct unpacker_factory;
+
 template<class Session, class Result>
-struct unpacker_factory {
-    typedef Result result_type;
+struct unpacker_factory<Session, Result(*)(std::shared_ptr<basic_receiver_t<Session>>, const msgpack::object&)> {
+    typedef Result(*result_type)(std::shared_ptr<basic_receiver_t<Session>>, const msgpack::object&);
 
     template<class T>
-    static inline
+    static constexpr
+    result_type
+    apply() {
+        return &unpack<T>;
+    }
+
+private:
+    template<class T>
+    static
+    Result
+    unpack(std::shared_ptr<basic_receiver_t<Session>> d, const msgpack::object& message) {
+        return unpacker<T, Session>()(std::move(d), message);
+    }
+};
+
+template<class Session, class Result>
+struct unpacker_factory<Session, Result(*)(const msgpack::object&)> {
+    typedef Result(*result_type)(const msgpack::object&);
+
+    template<class T>
+    static constexpr
     result_type
     apply() {
-        return unpacker<T, Session>();
+        return &unpack<T>;
+    }
+
+private:
+    template<class T>
+    static
+    Result
+    unpack(const msgpack::object& message) {
+        return unpacker<T, Session>()(message);
     }
 };
 
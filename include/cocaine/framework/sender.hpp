@@ -21,6 +21,7 @@
 
 #include "cocaine/framework/encoder.hpp"
 #include "cocaine/framework/forwards.hpp"
+#include "cocaine/framework/trace.hpp"
 
 #include <cocaine/rpc/asio/encoder.hpp>
 
@@ -41,6 +42,11 @@ class basic_sender_t {
 public:
     basic_sender_t(std::uint64_t id, std::shared_ptr<session_type> session);
 
+    /// Returns the channel id this sender is attached to.
+    auto span() const noexcept -> std::uint64_t {
+        return id;
+    }
+
     /*!
      * Pack given args in the message and push it through a session pointer.
      *
@@ -61,8 +67,25 @@ public:
         return send(io::encoded<Event>(id, std::forward<Args>(args)...));
     }
 
-private:
+    /// Sends the given event, which has a single raw argument, passing the blob to the socket as is
+    /// without copying it into the message buffer.
+    template<class Event>
+    auto
+    send_raw(blob_t blob) -> task<void>::future_type {
+        encoded_frames_t frames(id);
+        frames.append_raw_header<Event>(blob.size());
+        return send(std::move(frames), std::move(blob));
+    }
+
+    /// Pushes the already encoded message through the session pointer.
+    ///
+    /// \pre the message must be encoded using the channel id of this sender.
     auto send(io::encoder_t::message_type&& message) -> task<void>::future_type;
+
+    /// Pushes the already encoded message followed by the blob through the session pointer.
+    ///
+    /// \pre the message must end with a raw header, announcing the blob size.
+    auto send(io::encoder_t::message_type&& message, blob_t blob) -> task<void>::future_type;
 };
 
 template<class T, class Session>
@@ -102,7 +125,20 @@ public:
 
         auto d = std::move(this->d);
         auto future = d->template send<Event>(std::forward<Args>(args)...);
-        return future.then(trace_t::bind(&sender::traverse<Event>, std::placeholders::_1, std::move(d)));
+        return future.then(trace::bind(&sender::traverse<Event>, std::placeholders::_1, std::move(d)));
+    }
+
+    /// Sends the given event, which has a single raw argument, without copying the blob.
+    ///
+    /// \warning this sender will be invalidated after this call.
+    template<class Event>
+    typename task<sender<typename io::event_traits<Event>::dispatch_type, Session>>::future_type
+    send_raw(blob_t blob) {
+        BOOST_ASSERT(this->d);
+
+        auto d = std::move(this->d);
+        auto future = d->template send_raw<Event>(std::move(blob));
+        return future.then(trace::bind(&sender::traverse<Event>, std::placeholders::_1, std::move(d)));
     }
 
 private:
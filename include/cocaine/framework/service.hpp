@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <chrono>
+
 #include "cocaine/framework/forwards.hpp"
 #include "cocaine/framework/receiver.hpp"
 #include "cocaine/framework/service.inl.hpp"
@@ -30,20 +32,53 @@
 ///
 /// \unstable because it needs some user experience.
 
+namespace cocaine { namespace framework { namespace detail {
+    class locations_t;
+}}} // namespace cocaine::framework::detail
+
 namespace cocaine { namespace framework {
 
+/// Describes how a disconnected service is connected.
+///
+/// After a failed connection attempt the next one is delayed, and requests issued meanwhile wait
+/// for it, unless it is too far away.
+struct reconnect_policy_t {
+    /// Delay before the first retry, which doubles after each consecutive failed attempt.
+    std::chrono::milliseconds backoff_min;
+
+    /// Maximum delay between attempts.
+    std::chrono::milliseconds backoff_max;
+
+    /// Time a request may wait for the service to be connected.
+    std::chrono::milliseconds park_timeout;
+
+    /// Maximum number of requests waiting for the service to be connected.
+    std::size_t park_limit;
+
+    reconnect_policy_t() :
+        backoff_min(100),
+        backoff_max(30000),
+        park_timeout(5000),
+        park_limit(1024)
+    {}
+};
+
 /// The basic service class represents an untyped Cocaine service.
 ///
 /// You are restricted to create instances of this class directly, use \sa service_manager_t for
 /// this purposes.
 class basic_service_t {
+    friend class service_manager_t;
+    friend class service_manager_data;
+
 public:
     typedef session_t::native_handle_type native_handle_type;
     typedef std::vector<session_t::endpoint_type> endpoints_t;
 
 private:
     class impl;
-    std::unique_ptr<impl> d;
+    /// Shared by all handles of the same service created by the manager, including the session.
+    std::shared_ptr<impl> d;
     std::shared_ptr<session_t> session;
     scheduler_t& scheduler;
     internal_logger_t logger;
@@ -63,6 +98,17 @@ public:
 
     ~basic_service_t();
 
+private:
+    /// Constructs another handle of the service with the given state.
+    basic_service_t(internal_logger_t logger, std::shared_ptr<impl> d);
+
+    /// Creates a state of a new disconnected service.
+    static
+    std::shared_ptr<impl>
+    make_impl(std::string name, uint version, std::shared_ptr<detail::locations_t> locations, scheduler_t& scheduler,
+              reconnect_policy_t policy);
+
+public:
     /// Returns the name of this service given at the construction.
     const std::string&
     name() const noexcept;
@@ -71,6 +117,12 @@ public:
     uint
     version() const noexcept;
 
+    /// Sets whether the session drops pending channels when it is destroyed, instead of waiting
+    /// for them to complete.
+    ///
+    /// \note services created by the manager share a session between all handles of the same
+    /// service, so the policy is shared as well. It applies when the service is evicted or the
+    /// manager is destroyed, rather than when this handle is destroyed.
     auto hard_shutdown(bool policy = true) -> void;
 
     /// Tries to connect to the service through the Locator.
@@ -90,15 +142,112 @@ public:
     native_handle() const;
 
     template<class Event, class... Args>
-    typename task<typename invocation_result<Event>::type>::future_type
+    typename std::enable_if<
+        !is_mute<Event>::value,
+        typename task<typename invocation_result<Event>::type>::future_type
+    >::type
     invoke(Args&&... args) {
         namespace ph = std::placeholders;
 
         trace::context_holder holder("SI");
 
+        // Steady state fast path, which bypasses the connection future chain with its scheduler
+        // hops. The session tracks its connection state atomically.
+        if (session->connected()) {
+            return session->invoke<Event>(std::forward<Args>(args)...)
+                .then(trace::wrap(trace::bind(&basic_service_t::on_invoke<Event>, ph::_1)));
+        }
+
+        return connect()
+            .then(scheduler, trace::wrap(trace::bind(&basic_service_t::on_connect<Event, typename std::decay<Args>::type...>, ph::_1, session, std::forward<Args>(args)...)))
+            .then(scheduler, trace::wrap(trace::bind(&basic_service_t::on_invoke<Event>, ph::_1)));
+    }
+
+    /// Invokes the given mute event, which has neither upstream nor dispatch.
+    ///
+    /// Such events are sent without creating a channel, sender and receiver.
+    ///
+    /// \returns a future, which is set after the message is written.
+    template<class Event, class... Args>
+    typename std::enable_if<is_mute<Event>::value, task<void>::future_type>::type
+    invoke(Args&&... args) {
+        namespace ph = std::placeholders;
+
+        trace::context_holder holder("SU");
+
+        if (session->connected()) {
+            return session->invoke_mute<Event>(std::forward<Args>(args)...);
+        }
+
         return connect()
-            .then(scheduler, trace::wrap(trace_t::bind(&basic_service_t::on_connect<Event, typename std::decay<Args>::type...>, ph::_1, session, std::forward<Args>(args)...)))
-            .then(scheduler, trace::wrap(trace_t::bind(&basic_service_t::on_invoke<Event>, ph::_1)));
+            .then(scheduler, trace::wrap(trace::bind(&basic_service_t::on_connect_mute<Event, typename std::decay<Args>::type...>, ph::_1, session, std::forward<Args>(args)...)));
+    }
+
+    /// Invokes the given event once per arguments tuple, sending all invocations using a single
+    /// write operation.
+    ///
+    /// This is cheaper than calling invoke in a loop, because the connection is checked once and
+    /// all channels are opened at once.
+    ///
+    /// \returns futures with results in the order of the given arguments. Each of them is set
+    /// independently, but connection and write errors are propagated to all of them.
+    template<class Event, class... Args>
+    typename std::enable_if<
+        !is_mute<Event>::value,
+        std::vector<typename task<typename invocation_result<Event>::type>::future_type>
+    >::type
+    invoke_many(std::vector<std::tuple<Args...>> args) {
+        namespace ph = std::placeholders;
+
+        typedef typename invocation_result<Event>::type result_type;
+
+        if (args.empty()) {
+            return {};
+        }
+
+        trace::context_holder holder("SM");
+
+        auto promises = std::make_shared<std::vector<promise<result_type>>>(args.size());
+
+        std::vector<typename task<result_type>::future_type> futures;
+        futures.reserve(args.size());
+        for (auto& promise : *promises) {
+            futures.push_back(promise.get_future());
+        }
+
+        if (session->connected()) {
+            session->invoke_many<Event>(std::move(args))
+                .then(trace::wrap(trace::bind(&basic_service_t::on_invoke_many<Event>, ph::_1, promises)));
+        } else {
+            connect()
+                .then(scheduler, trace::wrap(trace::bind(&basic_service_t::on_connect_many<Event, Args...>, ph::_1, session, std::move(args))))
+                .then(scheduler, trace::wrap(trace::bind(&basic_service_t::on_invoke_many<Event>, ph::_1, promises)));
+        }
+
+        return futures;
+    }
+
+    /// Invokes the given mute event once per arguments tuple, sending all invocations using a
+    /// single write operation without creating channels.
+    ///
+    /// \returns a future, which is set after all messages are written.
+    template<class Event, class... Args>
+    typename std::enable_if<is_mute<Event>::value, task<void>::future_type>::type
+    invoke_many(std::vector<std::tuple<Args...>> args) {
+        namespace ph = std::placeholders;
+
+        if (args.empty()) {
+            return make_ready_future<void>::value();
+        }
+
+        trace::context_holder holder("SMU");
+
+        if (session->connected()) {
+            return session->invoke_mute_many<Event>(std::move(args));
+        }
+
+        return connect()
+            .then(scheduler, trace::wrap(trace::bind(&basic_service_t::on_connect_mute_many<Event, Args...>, ph::_1, session, std::move(args))));
     }
 
 private:
@@ -112,12 +261,76 @@ private:
         return session->invoke<Event>(std::forward<Args>(args)...);
     }
 
+    template<class Event, class... Args>
+    static
+    task<void>::future_type
+    on_connect_mute(task<void>::future_move_type future, std::shared_ptr<session_t> session, Args&... args) {
+        future.get();
+        return session->invoke_mute<Event>(std::forward<Args>(args)...);
+    }
+
+    template<class Event, class... Args>
+    static
+    task<void>::future_type
+    on_connect_mute_many(task<void>::future_move_type future, std::shared_ptr<session_t> session, std::vector<std::tuple<Args...>>& args) {
+        future.get();
+        return session->invoke_mute_many<Event>(std::move(args));
+    }
+
     template<class Event>
     static
     typename task<typename invocation_result<Event>::type>::future_type
     on_invoke(typename task<channel<Event>>::future_move_type future) {
         return invocation_result<Event>::apply(future.get());
     }
+
+    template<class Event, class... Args>
+    static
+    typename task<std::vector<channel<Event>>>::future_type
+    on_connect_many(task<void>::future_move_type future, std::shared_ptr<session_t> session, std::vector<std::tuple<Args...>>& args) {
+        future.get();
+        return session->invoke_many<Event>(std::move(args));
+    }
+
+    template<class Event>
+    static
+    void
+    on_invoke_many(typename task<std::vector<channel<Event>>>::future_move_type future,
+                   std::shared_ptr<std::vector<promise<typename invocation_result<Event>::type>>> promises)
+    {
+        std::vector<channel<Event>> channels;
+
+        try {
+            channels = future.get();
+        } catch (...) {
+            const auto error = std::current_exception();
+            for (auto& promise : *promises) {
+                promise.set_exception(error);
+            }
+            return;
+        }
+
+        for (std::size_t id = 0; id < channels.size(); ++id) {
+            invocation_result<Event>::apply(std::move(channels[id]))
+                .then(trace::wrap(trace::bind(&basic_service_t::on_result<Event>, std::placeholders::_1, promises, id)));
+        }
+    }
+
+    template<class Event>
+    static
+    void
+    on_result(typename task<typename invocation_result<Event>::type>::future_move_type future,
+              std::shared_ptr<std::vector<promise<typename invocation_result<Event>::type>>> promises,
+              std::size_t id)
+    {
+        auto& promise = (*promises)[id];
+
+        try {
+            promise.set_value(future.get());
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+    }
 };
 
 /// The service class represents a typed Cocaine service.
@@ -126,10 +339,19 @@ private:
 /// this purposes.
 template<class T>
 class service : public basic_service_t {
+    friend class service_manager_t;
+    friend class service_manager_data;
+
 public:
     service(internal_logger_t logger, std::string name, endpoints_t locations, scheduler_t& scheduler) :
         basic_service_t(std::move(logger), std::move(name), io::protocol<T>::version::value, std::move(locations), scheduler)
     {}
+
+private:
+    explicit
+    service(basic_service_t&& other) :
+        basic_service_t(std::move(other))
+    {}
 };
 
 }} // namespace cocaine::framework
@@ -63,6 +63,16 @@ struct invocation_result<Event, io::primitive_tag<T>, void> {
     }
 };
 
+/// The template trait specialization for mute events, which have neither upstream nor dispatch.
+///
+/// Such events are sent without creating a channel, so there is nothing to return.
+///
+/// \helper
+template<class Event>
+struct invocation_result<Event, void, void> {
+    typedef void type;
+};
+
 } // namespace framework
 
 } // namespace cocaine
@@ -17,6 +17,8 @@
 #pragma once
 
 #include <cstdint>
+#include <tuple>
+#include <vector>
 
 #include <boost/asio/ip/tcp.hpp>
 
@@ -83,19 +85,93 @@ public:
                     std::placeholders::_1,
                     std::forward<Args>(args)...
         );
-        return invoke(std::move(encode_cb)).then(scheduler, trace_t::bind(&session::on_invoke<Event>, std::placeholders::_1));
+        return invoke(std::move(encode_cb)).then(scheduler, trace::bind(&session::on_invoke<Event>, std::placeholders::_1));
+    }
+
+    /// Sends an invocation of the given mute event without creating a channel.
+    ///
+    /// \returns a future, which is set after the message is written.
+    template<class Event, class... Args>
+    typename task<void>::future_type
+    invoke_mute(Args&&... args) {
+        static_assert(is_mute<Event>::value, "only events with neither upstream nor dispatch can be mute");
+
+        auto encode_cb = std::bind(
+                    &encode<Event, Args...>,
+                    std::placeholders::_1,
+                    std::forward<Args>(args)...
+        );
+        return invoke_mute(std::move(encode_cb));
+    }
+
+    /// Sends invocations of the given event, one per arguments tuple, using a single write
+    /// operation.
+    ///
+    /// \returns a future with channels in the order of the given arguments.
+    template<class Event, class... Args>
+    typename task<std::vector<channel<Event>>>::future_type
+    invoke_many(std::vector<std::tuple<Args...>> args) {
+        const auto count = args.size();
+        auto encode_cb = std::bind(
+                    &encode_many<Event, Args...>,
+                    std::placeholders::_1,
+                    std::move(args)
+        );
+        return invoke_many(count, std::move(encode_cb)).then(scheduler, trace::bind(&session::on_invoke_many<Event>, std::placeholders::_1));
+    }
+
+    /// Sends invocations of the given mute event, one per arguments tuple, using a single write
+    /// operation without creating channels.
+    ///
+    /// \returns a future, which is set after all messages are written.
+    template<class Event, class... Args>
+    typename task<void>::future_type
+    invoke_mute_many(std::vector<std::tuple<Args...>> args) {
+        static_assert(is_mute<Event>::value, "only events with neither upstream nor dispatch can be mute");
+
+        const auto count = args.size();
+        auto encode_cb = std::bind(
+                    &encode_many<Event, Args...>,
+                    std::placeholders::_1,
+                    std::move(args)
+        );
+        return invoke_mute_many(count, std::move(encode_cb));
     }
 
 private:
     task<basic_invoke_result>::future_type
     invoke(encode_callback_t encode_callback);
 
+    task<std::vector<basic_invoke_result>>::future_type
+    invoke_many(std::size_t count, encode_callback_t encode_callback);
+
+    task<void>::future_type
+    invoke_mute(encode_callback_t encode_callback);
+
+    task<void>::future_type
+    invoke_mute_many(std::size_t count, encode_callback_t encode_callback);
+
     template<class Event>
     static
     channel<Event>
     on_invoke(task<basic_invoke_result>::future_move_type future) {
         return channel<Event>(future.get());
     }
+
+    template<class Event>
+    static
+    std::vector<channel<Event>>
+    on_invoke_many(task<std::vector<basic_invoke_result>>::future_move_type future) {
+        auto results = future.get();
+
+        std::vector<channel<Event>> channels;
+        channels.reserve(results.size());
+        for (auto& result : results) {
+            channels.emplace_back(std::move(result));
+        }
+
+        return channels;
+    }
 };
 
 typedef session<basic_session_t> session_t;
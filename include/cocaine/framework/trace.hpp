@@ -24,3 +24,5 @@
 #include "cocaine/framework/trace/disabled.hpp"
 #endif
 
+#include "cocaine/framework/trace/sampling.hpp"
+
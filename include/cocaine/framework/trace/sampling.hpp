@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+
+#include <boost/optional/optional.hpp>
+
+#include <cocaine/trace/trace.hpp>
+
+namespace cocaine { namespace framework { namespace trace {
+
+/// Head-based trace sampler.
+///
+/// The decision is made once when the trace enters the worker and depends only on the trace id,
+/// so all services configured with the same rate make the same decision for the same trace.
+class sampler_t {
+    /// Traces with mixed id below this threshold are sampled. The maximum value means sampling
+    /// everything.
+    std::uint64_t threshold;
+
+public:
+    /// Constructs a sampler that samples every trace.
+    sampler_t() :
+        threshold(std::numeric_limits<std::uint64_t>::max())
+    {}
+
+    /// Constructs a sampler with the given rate, where 0.0 means never and 1.0 means always.
+    explicit
+    sampler_t(double rate) :
+        threshold(rate >= 1.0
+            ? std::numeric_limits<std::uint64_t>::max()
+            : rate <= 0.0
+                ? 0
+                : static_cast<std::uint64_t>(rate * static_cast<double>(std::numeric_limits<std::uint64_t>::max())))
+    {}
+
+    auto sampled(std::uint64_t trace_id) const noexcept -> bool {
+        if (threshold == std::numeric_limits<std::uint64_t>::max()) {
+            return true;
+        }
+
+        return mix(trace_id) < threshold;
+    }
+
+private:
+    /// Spreads trace ids uniformly, because they are not guaranteed to be random.
+    static
+    auto mix(std::uint64_t value) noexcept -> std::uint64_t {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdULL;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ULL;
+        value ^= value >> 33;
+        return value;
+    }
+};
+
+/// The callable wrapper, which restores the captured trace scope before the invocation.
+///
+/// Like trace_t::bind it restores the empty trace if there was no trace captured, so the callable
+/// never inherits the trace of the thread it is executed on. Unlike it the empty trace is shared
+/// instead of being copied into every wrapper.
+template<class F>
+class traced_t {
+    boost::optional<trace_t> trace;
+    F fn;
+
+public:
+    traced_t(boost::optional<trace_t> trace, F fn) :
+        trace(std::move(trace)),
+        fn(std::move(fn))
+    {}
+
+    template<class... Args>
+    auto operator()(Args&&... args) -> decltype(fn(std::forward<Args>(args)...)) {
+        trace_t::restore_scope_t scope(trace ? trace : empty());
+        return fn(std::forward<Args>(args)...);
+    }
+
+private:
+    static
+    auto empty() -> const boost::optional<trace_t>& {
+        static const boost::optional<trace_t> trace = trace_t();
+        return trace;
+    }
+};
+
+/// Binds the given callable with its arguments, capturing the current trace if there is one.
+template<class F, class... Args>
+auto bind(F&& fn, Args&&... args) ->
+    traced_t<decltype(std::bind(std::forward<F>(fn), std::forward<Args>(args)...))>
+{
+    typedef decltype(std::bind(std::forward<F>(fn), std::forward<Args>(args)...)) bound_type;
+
+    const auto& current = trace_t::current();
+
+    return traced_t<bound_type>(
+        current.empty() ? boost::optional<trace_t>() : boost::optional<trace_t>(current),
+        std::bind(std::forward<F>(fn), std::forward<Args>(args)...)
+    );
+}
+
+}}} // namespace cocaine::framework::trace
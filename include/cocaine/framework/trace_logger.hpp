@@ -1,4 +1,7 @@
 #pragma once
+#include <cstdint>
+#include <memory>
+
 #include <cocaine/trace/trace.hpp>
 #include "cocaine/framework/forwards.hpp"
 
@@ -12,18 +15,43 @@ class internal_logger_t
 {
 public:
     class impl;
+
+    /// Counters describing the logging queue state.
+    struct stats_t {
+        /// Number of records ever accepted by the logger.
+        std::uint64_t queued;
+        /// Number of records written to the logging service.
+        std::uint64_t sent;
+        /// Number of records dropped because of the queue overflow or a failed write.
+        std::uint64_t dropped;
+    };
+
     ~internal_logger_t();
 
     /**
+     * Starts a new background flusher for the given logging service.
+     *
      * Valid only when manager is in scope, so lifetime should be controlled manually.
      */
     internal_logger_t(std::shared_ptr<service<io::log_tag>> logger_service);
 
+    /**
+     * Copies share the same queue and flusher, which stops after the last copy is destroyed.
+     */
+    internal_logger_t(const internal_logger_t&);
+
     internal_logger_t(internal_logger_t&&);
 
+    /**
+     * Enqueues the message with the current trace attributes to be sent later by the background
+     * flusher. Never blocks; on queue overflow the oldest record is dropped.
+     */
     void
     log(std::string message);
 
+    stats_t
+    stats() const;
+
 private:
     /**
      * Constructs an empty object that does nothing
@@ -32,7 +60,7 @@ private:
 
     friend class service_manager_data;
 
-    std::unique_ptr<impl> d;
+    std::shared_ptr<impl> d;
 };
 
 }}
@@ -21,6 +21,7 @@
 #include <string>
 
 #include "cocaine/framework/forwards.hpp"
+#include "cocaine/framework/metrics.hpp"
 #include "cocaine/framework/worker/dispatch.hpp"
 #include "cocaine/framework/worker/options.hpp"
 
@@ -63,6 +64,10 @@ public:
         on(std::move(event), worker::transform_traits<dispatch_type, F>::apply(std::move(handler)));
     }
 
+    /// Returns the service manager for user purposes.
+    ///
+    /// Services may be warmed up using it before the worker is run, so it accepts requests only
+    /// after all of them are connected.
     service_manager_t&
     manager();
 
@@ -72,9 +77,25 @@ public:
     void
     fallback(fallback_type handler);
 
+    /// Registers the given event, which replies with a msgpack-encoded snapshot of this worker
+    /// metrics, allowing to scrape them through the runtime without any code in the application.
+    ///
+    /// The reply is a single chunk with a map of "counters", "gauges" and "histograms", each of
+    /// them mapping a metric name to its value. Histograms are reduced to their "count", "sum",
+    /// "mean", "max", "p50", "p90", "p99" and "p999" values in microseconds.
+    void
+    expose_metrics(std::string event = "__stats__");
+
     auto
     options() const -> const options_t&;
 
+    /// Returns a snapshot of metrics collected by this worker, including ones of its service
+    /// manager.
+    ///
+    /// \threadsafe
+    auto
+    metrics() const -> metrics_snapshot_t;
+
     auto
     token() const -> token_t;
 
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <type_traits>
+
 #include "cocaine/framework/worker/error.hpp"
 #include "cocaine/framework/worker/http/request.hpp"
 #include "cocaine/framework/worker/http/response.hpp"
@@ -55,6 +57,64 @@ struct basic_middleware {
     }
 };
 
+/*!
+ * The zero-copy middleware trait.
+ *
+ * Provides the request view, which fields point directly into the received frame instead of being
+ * copied out of it. Useful for large requests or when most of headers are not needed.
+ */
+struct view_middleware {
+    typedef http_request_view_t request_type;
+    typedef http_response_t response_type;
+
+    static
+    request_type
+    map_request(http_request_view_t&& rq) {
+        return std::move(rq);
+    }
+
+    static
+    http_response_t
+    map_response(response_type&& rs) {
+        return rs;
+    }
+};
+
+namespace detail {
+
+/// Checks whether the given middleware is able to map the request view directly, without
+/// converting it into the owning request first.
+template<class M>
+struct accepts_request_view {
+private:
+    template<class U>
+    static
+    auto
+    test(int) -> decltype(U::map_request(std::declval<http_request_view_t>()), std::true_type());
+
+    template<class>
+    static
+    std::false_type
+    test(...);
+
+public:
+    static constexpr bool value = decltype(test<M>(0))::value;
+};
+
+template<class M>
+typename M::request_type
+map_request(http_request_view_t&& rq, std::true_type) {
+    return M::map_request(std::move(rq));
+}
+
+template<class M>
+typename M::request_type
+map_request(http_request_view_t&& rq, std::false_type) {
+    return M::map_request(rq.to_request());
+}
+
+} // namespace detail
+
 template<class State, class Middleware>
 class http_sender;
 
@@ -159,19 +219,88 @@ public:
      */
     typename task<http_sender<http::streaming, M>>::future_type
     send(typename M::response_type response) {
-        msgpack::sbuffer buffer;
-        msgpack::packer<msgpack::sbuffer> packer(buffer);
-        io::type_traits<
-            http_response_t
-        >::pack(packer, M::map_response(std::move(response)));
+        auto& head = pack(std::move(response));
+
+        auto tx = std::move(this->tx);
+        auto future = tx.write(std::vector<boost::string_ref>{boost::string_ref(head.data(), head.size())});
+        return future
+            .then(std::bind(&http_sender::transform, std::placeholders::_1));
+    }
+
+    /*!
+     * Encodes the response object and writes it to the stream together with the first body chunk
+     * using a single write operation.
+     *
+     * \warning the current object will be invalidated after this call.
+     */
+    typename task<http_sender<http::streaming, M>>::future_type
+    send(typename M::response_type response, boost::string_ref body) {
+        auto& head = pack(std::move(response));
+
+        auto tx = std::move(this->tx);
+        auto future = tx.write({boost::string_ref(head.data(), head.size()), body});
+        return future
+            .then(std::bind(&http_sender::transform, std::placeholders::_1));
+    }
 
+    /*!
+     * Writes the pre-encoded response head to the stream together with the first body chunk using
+     * a single write operation.
+     *
+     * \note the middleware is not involved, because the response is already encoded.
+     *
+     * \warning the current object will be invalidated after this call.
+     */
+    typename task<http_sender<http::streaming, M>>::future_type
+    send(const encoded_http_response_t& response, boost::string_ref body) {
         auto tx = std::move(this->tx);
-        auto future = tx.write(std::string(buffer.data(), buffer.size()));
+        auto future = tx.write({response.data(), body});
         return future
             .then(std::bind(&http_sender::transform, std::placeholders::_1));
     }
 
+    /*!
+     * Writes the complete response, i.e. its head, the whole body and the end of stream using a
+     * single write operation.
+     *
+     * \warning the current object will be invalidated after this call.
+     */
+    task<void>::future_type
+    send_and_close(typename M::response_type response, boost::string_ref body) {
+        auto& head = pack(std::move(response));
+
+        auto tx = std::move(this->tx);
+        return tx.write_and_close({boost::string_ref(head.data(), head.size()), body});
+    }
+
+    /*!
+     * Writes the complete response with the pre-encoded head using a single write operation.
+     *
+     * \warning the current object will be invalidated after this call.
+     */
+    task<void>::future_type
+    send_and_close(const encoded_http_response_t& response, boost::string_ref body) {
+        auto tx = std::move(this->tx);
+        return tx.write_and_close({response.data(), body});
+    }
+
 private:
+    /// Packs the response head into the thread-local buffer, which is reused between calls to avoid
+    /// allocating on every response. The result is valid until the next call on the same thread.
+    static
+    const msgpack::sbuffer&
+    pack(typename M::response_type response) {
+        static thread_local msgpack::sbuffer buffer;
+        buffer.clear();
+
+        msgpack::packer<msgpack::sbuffer> packer(buffer);
+        io::type_traits<
+            http_response_t
+        >::pack(packer, M::map_response(std::move(response)));
+
+        return buffer;
+    }
+
     static
     http_sender<http::streaming, M>
     transform(task<sender>::future_move_type future) {
@@ -191,7 +320,7 @@ class http_receiver<http::streaming, M> {
 
     // I do not use boost::optional here, because of its late move-semantics support.
     bool cached;
-    std::string body;
+    chunk_t body;
 
 public:
     /*!
@@ -216,6 +345,16 @@ public:
         body(std::move(body))
     {}
 
+    /*!
+     * Constructs a streaming HTTP receiver using the underlying string receiver and the body
+     * chunk, which refers to the first received frame.
+     */
+    http_receiver(receiver rx, chunk_t body) :
+        rx(std::move(rx)),
+        cached(true),
+        body(std::move(body))
+    {}
+
     http_receiver(const http_receiver& other) = default;
     http_receiver(http_receiver&& other) = default;
 
@@ -225,17 +364,35 @@ public:
     /*!
      * Tries to receive another chunk of data from the stream.
      *
+     * Either std::string or chunk_t can be specified as a result type. The latter provides a view
+     * into the received frame, allowing to pass large bodies through without copying.
+     *
      * \return a future, which will be set after receiving the next message from the stream. It may
      * contain none value, indicating that the other side has closed the stream for writing.
      */
-    task<boost::optional<std::string>>::future_type
+    template<class R = std::string>
+    typename task<boost::optional<R>>::future_type
     recv() {
         if (cached) {
             cached = false;
-            return make_ready_future<boost::optional<std::string>>::value(body);
+            return make_ready_future<boost::optional<R>>::value(take(tag<R>()));
         }
 
-        return rx.recv();
+        return rx.recv<R>();
+    }
+
+private:
+    template<class>
+    struct tag {};
+
+    std::string
+    take(tag<std::string>) {
+        return body.to_string();
+    }
+
+    chunk_t
+    take(tag<chunk_t>) {
+        return std::move(body);
     }
 };
 
@@ -276,30 +433,39 @@ public:
     typename task<std::tuple<request_type, http_receiver<http::streaming, M>>>::future_type
     recv() {
         auto rx = std::move(this->rx);
-        return rx.recv()
+        return rx.recv<chunk_t>()
             .then(std::bind(&http_receiver::transform, std::placeholders::_1, rx));
     }
 
 private:
+    /// Unpacks the request directly from the received frame. Both request fields and the body
+    /// refer to the frame's data, which is copied only if the middleware requires an owning
+    /// request.
     static
     std::tuple<typename M::request_type, http_receiver<http::streaming, M>>
-    transform(task<boost::optional<std::string>>::future_move_type future, receiver rx) {
-        auto unpacked = future.get();
+    transform(task<boost::optional<chunk_t>>::future_move_type future, receiver rx) {
+        auto chunk = future.get();
 
-        if (!unpacked) {
+        if (!chunk) {
             throw unexpected_eof();
         }
 
+        const auto data = chunk->data();
+
         msgpack::unpacked msg;
-        msgpack::unpack(&msg, unpacked->data(), unpacked->size());
+        msgpack::unpack(&msg, data.data(), data.size());
 
-        http_request_t request;
-        std::string body;
-        io::type_traits<http_request_t>::unpack(msg.get(), request, body);
+        http_request_view_t request;
+        boost::string_ref body;
+        io::type_traits<http_request_view_t>::unpack(msg.get(), request, body);
+        request.frame = *chunk;
 
         return std::make_tuple(
-            M::map_request(std::move(request)),
-            http_receiver<http::streaming, M>(std::move(rx), std::move(body))
+            detail::map_request<M>(
+                std::move(request),
+                std::integral_constant<bool, detail::accepts_request_view<M>::value>()
+            ),
+            http_receiver<http::streaming, M>(std::move(rx), chunk->slice(body))
         );
     }
 };
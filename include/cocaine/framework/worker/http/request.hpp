@@ -19,8 +19,12 @@
 #include <string>
 #include <vector>
 
+#include <boost/utility/string_ref.hpp>
+
 #include <cocaine/traits/tuple.hpp>
 
+#include "cocaine/framework/worker/receiver.hpp"
+
 namespace cocaine {
 
 namespace framework {
@@ -34,6 +38,39 @@ struct http_request_t {
     std::vector<std::pair<std::string, std::string>> headers;
 };
 
+/// The HTTP request view represents the first HTTP request information without owning it.
+///
+/// All fields point directly into the received frame, which is kept alive by the frame member until
+/// this object is destroyed.
+struct http_request_view_t {
+    boost::string_ref method;
+    boost::string_ref uri;
+    boost::string_ref version;
+    std::vector<std::pair<boost::string_ref, boost::string_ref>> headers;
+
+    /// The chunk the request was unpacked from.
+    chunk_t frame;
+
+    /// Copies the viewed request into an owning one.
+    http_request_t
+    to_request() const {
+        http_request_t result;
+        result.method.assign(method.data(), method.size());
+        result.uri.assign(uri.data(), uri.size());
+        result.version.assign(version.data(), version.size());
+        result.headers.reserve(headers.size());
+
+        for (const auto& header : headers) {
+            result.headers.emplace_back(
+                std::string(header.first.data(), header.first.size()),
+                std::string(header.second.data(), header.second.size())
+            );
+        }
+
+        return result;
+    }
+};
+
 } // namespace worker
 
 } // namespace framework
@@ -68,6 +105,57 @@ struct type_traits<framework::worker::http_request_t> {
     }
 };
 
+/// Unpacks the HTTP request without copying, making all fields refer to the unpacked object's raw
+/// data.
+template<>
+struct type_traits<framework::worker::http_request_view_t> {
+    static inline
+    void
+    unpack(const msgpack::object& unpacked, framework::worker::http_request_view_t& target, boost::string_ref& body) {
+        if (unpacked.type != msgpack::type::ARRAY || unpacked.via.array.size != 5) {
+            throw msgpack::type_error();
+        }
+
+        const msgpack::object* fields = unpacked.via.array.ptr;
+
+        target.method  = view(fields[0]);
+        target.uri     = view(fields[1]);
+        target.version = view(fields[2]);
+
+        if (fields[3].type != msgpack::type::ARRAY) {
+            throw msgpack::type_error();
+        }
+
+        const auto& headers = fields[3].via.array;
+
+        target.headers.clear();
+        target.headers.reserve(headers.size);
+
+        for (std::size_t id = 0; id < headers.size; ++id) {
+            const auto& header = headers.ptr[id];
+
+            if (header.type != msgpack::type::ARRAY || header.via.array.size != 2) {
+                throw msgpack::type_error();
+            }
+
+            target.headers.emplace_back(view(header.via.array.ptr[0]), view(header.via.array.ptr[1]));
+        }
+
+        body = view(fields[4]);
+    }
+
+private:
+    static inline
+    boost::string_ref
+    view(const msgpack::object& object) {
+        if (object.type != msgpack::type::RAW) {
+            throw msgpack::type_error();
+        }
+
+        return boost::string_ref(object.via.raw.ptr, object.via.raw.size);
+    }
+};
+
 } // namespace io
 
 } // namespace cocaine
@@ -19,6 +19,8 @@
 #include <string>
 #include <vector>
 
+#include <boost/utility/string_ref.hpp>
+
 #include <cocaine/traits/tuple.hpp>
 
 namespace cocaine {
@@ -65,4 +67,36 @@ struct type_traits<framework::worker::http_response_t> {
 
 } // namespace io
 
+namespace framework {
+
+namespace worker {
+
+/// The HTTP response head (status code and headers), which is encoded once during construction.
+///
+/// Useful for common responses, like 200 with a fixed content type, which can be created once and
+/// then sent without packing on every request.
+class encoded_http_response_t {
+    std::string encoded;
+
+public:
+    explicit
+    encoded_http_response_t(const http_response_t& response) {
+        msgpack::sbuffer buffer;
+        msgpack::packer<msgpack::sbuffer> packer(buffer);
+        io::type_traits<http_response_t>::pack(packer, response);
+
+        encoded.assign(buffer.data(), buffer.size());
+    }
+
+    /// Returns the encoded response head.
+    boost::string_ref
+    data() const noexcept {
+        return encoded;
+    }
+};
+
+} // namespace worker
+
+} // namespace framework
+
 } // namespace cocaine
@@ -46,6 +46,17 @@ struct options_t {
 
     std::string
     token_body() const;
+
+    /// Returns the fraction of traced requests, which are actually traced by the worker, taken
+    /// from the COCAINE_FRAMEWORK_TRACE_SAMPLE_RATE environment variable. Defaults to 1.0.
+    double
+    trace_sample_rate() const;
+
+    /// Returns the number of userland executor threads, taken from the
+    /// COCAINE_FRAMEWORK_WORKER_THREADS environment variable. Defaults to the number of hardware
+    /// threads.
+    unsigned int
+    threads() const;
 private:
     std::unordered_map<std::string, boost::any> other;
 };
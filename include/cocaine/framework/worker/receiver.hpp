@@ -16,13 +16,18 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <string>
 
 #include <boost/optional/optional.hpp>
+#include <boost/utility/string_ref.hpp>
+
+#include <msgpack.hpp>
 
 #include <cocaine/forwards.hpp>
 #include <cocaine/hpack/header.hpp>
+#include <cocaine/traits.hpp>
 
 #include "cocaine/framework/forwards.hpp"
 
@@ -35,20 +40,77 @@ struct frame_t {
     hpack::headers_t meta;
 };
 
+/// Represents a view of the single chunk payload, which points directly into the received frame.
+///
+/// The frame is kept alive as long as at least one chunk referring to it exists, so the data is
+/// valid during the whole chunk lifetime without being copied.
+class chunk_t {
+    std::shared_ptr<const void> owner;
+    boost::string_ref view;
+
+public:
+    /// Constructs an empty chunk.
+    chunk_t();
+
+    /// Constructs a chunk viewing the given data, which lifetime is controlled by the owner.
+    chunk_t(std::shared_ptr<const void> owner, boost::string_ref view);
+
+    /// Constructs a chunk owning the given string.
+    explicit chunk_t(std::string data);
+
+    /// Returns the view of the chunk payload.
+    auto data() const noexcept -> boost::string_ref;
+
+    /// Returns a chunk, which refers to the given part of this chunk's payload and shares the same
+    /// underlying frame.
+    ///
+    /// \pre the given view must point into this chunk's payload.
+    auto slice(boost::string_ref view) const -> chunk_t;
+
+    /// Copies the chunk payload into a string.
+    auto to_string() const -> std::string;
+};
+
 class receiver {
     hpack::headers_t headers;
     std::shared_ptr<basic_receiver_t<worker_session_t>> session;
 
 public:
     /// \note this constructor is intentionally left implicit.
-    receiver(const std::vector<hpack::header_t>& headers,
+    receiver(std::vector<hpack::header_t> headers,
              std::shared_ptr<basic_receiver_t<worker_session_t>> session);
 
     /// Returns a const lvalue reference to headers that were passed with an invocation event.
     auto invocation_headers() const noexcept -> const hpack::headers_t&;
 
+    /// Receives the next chunk, unpacking its payload as a MessagePack'ed object of the given type
+    /// directly from the received frame using io::type_traits.
+    ///
+    /// There are also specializations for std::string, frame_t and chunk_t, which provide the raw
+    /// chunk data as is.
     template<typename R = std::string>
     auto recv() -> future<boost::optional<R>>;
+
+private:
+    template<typename R>
+    static
+    auto
+    unpack(future<boost::optional<chunk_t>>& future) -> boost::optional<R> {
+        const auto chunk = future.get();
+
+        if (!chunk) {
+            return boost::none;
+        }
+
+        const auto data = chunk->data();
+
+        msgpack::unpacked unpacked;
+        msgpack::unpack(&unpacked, data.data(), data.size());
+
+        R result;
+        io::type_traits<R>::unpack(unpacked.get(), result);
+        return boost::make_optional(std::move(result));
+    }
 };
 
 template<>
@@ -57,6 +119,16 @@ auto receiver::recv<std::string>() -> future<boost::optional<std::string>>;
 template<>
 auto receiver::recv<frame_t>() -> future<boost::optional<frame_t>>;
 
+/// Receives the next chunk without copying its payload out of the frame.
+template<>
+auto receiver::recv<chunk_t>() -> future<boost::optional<chunk_t>>;
+
+template<typename R>
+auto receiver::recv() -> future<boost::optional<R>> {
+    return recv<chunk_t>()
+        .then(std::bind(&receiver::unpack<R>, std::placeholders::_1));
+}
+
 } // namespace worker
 } // namespace framework
 } // namespace cocaine
@@ -18,22 +18,38 @@
 
 #include <memory>
 #include <string>
+#include <vector>
+
+#include <boost/utility/string_ref.hpp>
 
 #include <cocaine/forwards.hpp>
 
+#include "cocaine/framework/encoder.hpp"
 #include "cocaine/framework/forwards.hpp"
 
 namespace cocaine {
 namespace framework {
+
+namespace detail { namespace worker {
+    class meter_t;
+}} // namespace detail::worker
+
 namespace worker {
 
 class sender {
     std::shared_ptr<basic_sender_t<worker_session_t>> session;
+    std::shared_ptr<detail::worker::meter_t> meter;
 
 public:
     /// \note this constructor is intentionally left implicit.
     sender(std::shared_ptr<basic_sender_t<worker_session_t>> session);
 
+    /// Constructs a sender, which reports the invocation progress into the given meter.
+    ///
+    /// \internal
+    sender(std::shared_ptr<basic_sender_t<worker_session_t>> session,
+           std::shared_ptr<detail::worker::meter_t> meter);
+
     /// Copy construction is explicitly forbidden to avoid protocol violation.
     sender(const sender& other) = delete;
     sender(sender&& other) = default;
@@ -50,6 +66,24 @@ public:
     ///     involve rvalue reference from this, but our compilers doesn't support it yey.
     auto write(std::string message) -> task<sender>::future_type;
 
+    /// Writes the provided blob into the associated channel as a single chunk without copying it,
+    /// which is preferred for large payloads.
+    ///
+    /// \warning this sender will be invalidated after this call.
+    auto write(blob_t blob) -> task<sender>::future_type;
+
+    /// Writes the provided messages into the associated channel as separate chunks, encoding all of
+    /// them into a single buffer, which is sent using a single write operation.
+    ///
+    /// \warning this sender will be invalidated after this call.
+    auto write(const std::vector<boost::string_ref>& messages) -> task<sender>::future_type;
+
+    /// Writes the provided messages into the associated channel and closes it using a single write
+    /// operation.
+    ///
+    /// \warning this sender will be invalidated after this call.
+    auto write_and_close(const std::vector<boost::string_ref>& messages) -> task<void>::future_type;
+
     /// Sends an error into the associated channel.
     ///
     /// \warning this sender will be invalidated after this call. The proper signature should
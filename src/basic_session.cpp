@@ -16,6 +16,7 @@
 
 #include "cocaine/framework/detail/basic_session.hpp"
 
+#include <chrono>
 #include <memory>
 
 #include <asio/connect.hpp>
@@ -27,6 +28,7 @@
 #include "cocaine/framework/detail/log.hpp"
 #include "cocaine/framework/detail/loop.hpp"
 #include "cocaine/framework/detail/net.hpp"
+#include "cocaine/framework/detail/channel.hpp"
 #include "cocaine/framework/detail/shared_state.hpp"
 
 #include <cocaine/trace/trace.hpp>
@@ -41,28 +43,38 @@ using namespace cocaine::framework::detail;
 class basic_session_t::push_t:
     public std::enable_shared_from_this<push_t>
 {
-    const io::encoder_t::message_type message;
+    io::encoder_t::message_type message;
+    blob_t blob;
+
+    const std::size_t size;
 
     // Keeps the session alive until all the operations are complete.
     const std::shared_ptr<basic_session_t> session;
 
     promise<void> pr;
 
+    const std::chrono::steady_clock::time_point start;
+
 public:
     push_t(io::encoder_t::message_type&& message,
+           blob_t blob,
            std::shared_ptr<basic_session_t> session,
            promise<void>&& pr) :
         message(std::move(message)),
+        blob(std::move(blob)),
+        size(this->message.size() + this->blob.size()),
         session(std::move(session)),
-        pr(std::move(pr))
+        pr(std::move(pr)),
+        start(std::chrono::steady_clock::now())
     {}
 
     void
-    operator()(std::shared_ptr<transport_type> transport) {
+    operator()(std::shared_ptr<writer_type> writer) {
         CF_DBG("writing message ...");
 
-        transport->writer->write(
-            message,
+        writer->write(
+            std::move(message),
+            std::move(blob),
             trace::wrap(std::bind(&push_t::on_write, shared_from_this(), ph::_1))
         );
     }
@@ -76,18 +88,36 @@ private:
             session->on_error(ec);
             pr.set_exception(std::system_error(ec));
         } else {
+            session->metrics.frames_written.inc();
+            session->metrics.bytes_written.inc(size);
+            session->metrics.write_latency.record_since(start);
             pr.set_value();
         }
     }
 };
 
+basic_session_t::metrics_t::metrics_t(detail::metrics::registry_t& registry) :
+    channels(registry.gauge("session.channels")),
+    frames_read(registry.counter("session.frames.read")),
+    bytes_read(registry.counter("session.bytes.read")),
+    frames_written(registry.counter("session.frames.written")),
+    bytes_written(registry.counter("session.bytes.written")),
+    connects(registry.counter("session.connects")),
+    errors(registry.counter("session.errors")),
+    write_latency(registry.histogram("session.write.latency")),
+    response_latency(registry.histogram("session.response.latency"))
+{}
+
 basic_session_t::basic_session_t(scheduler_t& scheduler) noexcept :
     scheduler(scheduler),
     closed(false),
     state(0),
     counter(1),
     message(boost::none),
-    hard_shutdown_(false)
+    slab(std::make_shared<detail::slab_t>()),
+    receivers(std::make_shared<detail::slab_t>()),
+    hard_shutdown_(false),
+    metrics(scheduler.loop().metrics)
 {}
 
 basic_session_t::~basic_session_t() {}
@@ -131,7 +161,7 @@ basic_session_t::connect(const std::vector<endpoint_type>& endpoints) {
         asio::async_connect(
             socket_ref,
             converted.begin(), converted.end(),
-            trace::wrap(trace_t::bind(
+            trace::wrap(trace::bind(
 				&basic_session_t::on_connect,
                 shared_from_this(), ph::_1, std::move(pr), std::move(socket)
 			))
@@ -178,7 +208,7 @@ basic_session_t::cancel() {
     closed = true;
     if (channels->empty() || hard_shutdown_) {
         CF_DBG("<< stop listening");
-        transport.synchronize()->reset();
+        detach();
     }
 
     CF_DBG("<< disconnected");
@@ -194,11 +224,13 @@ basic_session_t::invoke(encode_callback_t encode_callback) {
     CF_CTX("bI" + std::to_string(span));
     CF_DBG("invoking span %llu event ...", CF_US(span));
 
-    auto tx    = std::make_shared<basic_sender_t<basic_session_t>>(span, shared_from_this());
-    auto state = std::make_shared<shared_state_t>();
-    auto rx    = std::make_shared<basic_receiver_t<basic_session_t>>(span, shared_from_this(), state);
+    auto channel = detail::make_channel(span, shared_from_this(), slab, receivers);
+    auto tx = std::move(channel.tx);
+    auto rx = std::move(channel.rx);
+
+    channels->insert(std::make_pair(span, channel_entry_t{channel.state, std::chrono::steady_clock::now()}));
+    metrics.channels.inc();
 
-    channels->insert(std::make_pair(span, std::move(state)));
     return push(encode_callback(span))
         .then(scheduler, trace::wrap([tx, rx](future<void>& fr) -> invoke_result {
             fr.get();
@@ -206,18 +238,81 @@ basic_session_t::invoke(encode_callback_t encode_callback) {
         }));
 }
 
+framework::future<void>
+basic_session_t::invoke_mute(encode_callback_t encode_callback) {
+    // Channel ids must still be written in ascending order.
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const auto span = counter++;
+
+    CF_CTX("bU" + std::to_string(span));
+    CF_DBG("invoking span %llu mute event ...", CF_US(span));
+
+    return push(encode_callback(span));
+}
+
+framework::future<void>
+basic_session_t::invoke_mute_many(std::size_t count, encode_callback_t encode_callback) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const auto span = counter.fetch_add(count);
+
+    CF_CTX("bUM" + std::to_string(span));
+    CF_DBG("invoking %llu mute events starting from span %llu ...", CF_US(count), CF_US(span));
+
+    return push(encode_callback(span));
+}
+
+framework::future<std::vector<basic_session_t::invoke_result>>
+basic_session_t::invoke_many(std::size_t count, encode_callback_t encode_callback) {
+    // Channel ids must reach the other side in ascending order, so the lock is held until the
+    // batch is pushed, as in the single invocation case.
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const auto span = counter.fetch_add(count);
+
+    CF_CTX("bM" + std::to_string(span));
+    CF_DBG("invoking %llu events starting from span %llu ...", CF_US(count), CF_US(span));
+
+    auto result = std::make_shared<std::vector<invoke_result>>();
+    result->reserve(count);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    channels.apply([&](channel_map_type& channels) {
+        for (std::uint64_t id = span; id < span + count; ++id) {
+            auto channel = detail::make_channel(id, shared_from_this(), slab, receivers);
+
+            channels.insert(std::make_pair(id, channel_entry_t{channel.state, start}));
+            result->push_back(std::make_tuple(std::move(channel.tx), std::move(channel.rx)));
+        }
+    });
+    metrics.channels.inc(static_cast<std::int64_t>(count));
+
+    return push(encode_callback(span))
+        .then(scheduler, trace::wrap([result](future<void>& fr) -> std::vector<invoke_result> {
+            fr.get();
+            return std::move(*result);
+        }));
+}
+
 framework::future<void>
 basic_session_t::push(io::encoder_t::message_type&& message) {
+    return push(std::move(message), blob_t());
+}
+
+framework::future<void>
+basic_session_t::push(io::encoder_t::message_type&& message, blob_t blob) {
     CF_CTX("bP");
     CF_DBG(">> writing message ...");
 
     promise<void> pr;
     auto fr = pr.get_future();
 
-    auto transport = *this->transport.synchronize();
-    if (transport) {
-        auto pusher = std::make_shared<push_t>(std::move(message), shared_from_this(), std::move(pr));
-        (*pusher)(transport);
+    auto writer = *this->writer.synchronize();
+    if (writer) {
+        auto pusher = std::make_shared<push_t>(std::move(message), std::move(blob), shared_from_this(), std::move(pr));
+        (*pusher)(writer);
     } else {
         pr.set_exception(std::system_error(asio::error::not_connected));
     }
@@ -230,12 +325,15 @@ basic_session_t::revoke(std::uint64_t span) {
     CF_DBG(">> revoking span %llu channel", CF_US(span));
 
     auto channels = this->channels.synchronize();
-    channels->erase(span);
+    if (channels->erase(span) > 0) {
+        metrics.channels.dec();
+    }
+
     if (closed && channels->empty()) {
         // At this moment there are no references left to this session and also nobody is intrested
         // for data reading.
         CF_DBG("<< stop listening");
-        transport.synchronize()->reset();
+        detach();
     }
 
     CF_DBG("<< revoke span %llu channel", CF_US(span));
@@ -247,15 +345,18 @@ basic_session_t::on_connect(const std::error_code& ec, promise<std::error_code>
 
     if (ec) {
         state = static_cast<std::uint8_t>(state_t::disconnected);
-        transport.synchronize()->reset();
+        detach();
     } else {
         CF_CTX_POP();
         CF_CTX("bR");
         CF_DBG(">> listening for read events ...");
 
         state = static_cast<std::uint8_t>(state_t::connected);
+        metrics.connects.inc();
+
         auto transport = this->transport.synchronize();
         transport->reset(new transport_type(std::move(socket)));
+        *writer.synchronize() = std::make_shared<writer_type>((*transport)->socket);
         pull(*transport);
     }
 
@@ -272,18 +373,31 @@ basic_session_t::on_read(const std::error_code& ec) {
     }
 
     CF_DBG("received message [%llu, %llu, %s]", CF_US(message.span()), CF_US(message.type()), CF_MSG(message.args()).c_str());
+    metrics.frames_read.inc();
+    metrics.bytes_read.inc(message.size());
+
+    std::chrono::steady_clock::time_point start;
+
     auto state = channels.apply([&](channel_map_type& channels) -> std::shared_ptr<shared_state_t> {
          auto it = channels.find(message.span());
          if (it == channels.end()) {
              CF_DBG("dropping an orphan span %llu message", CF_US(message.span()));
              return nullptr;
          } else {
-             return it->second;
+             // Only the first response is accounted.
+             std::swap(start, it->second.start);
+             return it->second.state.lock();
          }
     });
 
     if (state) {
         state->put(std::move(message));
+
+        // Continuations attached to the receiver future without a scheduler have already been
+        // invoked while putting the message, so they are accounted as well.
+        if (start != std::chrono::steady_clock::time_point()) {
+            metrics.response_latency.record_since(start);
+        }
     }
 
     auto transport = this->transport.synchronize();
@@ -297,25 +411,35 @@ basic_session_t::on_error(const std::error_code& ec) {
     BOOST_ASSERT(ec);
 
     state = static_cast<std::uint8_t>(state_t::disconnected);
+    metrics.errors.inc();
 
     auto channels = this->channels.apply([&](channel_map_type& channels) -> channel_map_type {
         auto copy = channels;
         channels.clear();
         return copy;
     });
+    metrics.channels.dec(static_cast<std::int64_t>(channels.size()));
 
-    for (auto channel : channels) {
-        channel.second->put(ec);
+    for (const auto& channel : channels) {
+        if (auto state = channel.second.state.lock()) {
+            state->put(ec);
+        }
     }
 }
 
+void
+basic_session_t::detach() {
+    writer.synchronize()->reset();
+    transport.synchronize()->reset();
+}
+
 void
 basic_session_t::pull(std::shared_ptr<transport_type> transport) {
     CF_DBG(">> listening for read events ...");
 
     transport->reader->read(
         message,
-        trace::wrap(trace_t::bind(&basic_session_t::on_read, shared_from_this(), ph::_1))
+        trace::wrap(trace::bind(&basic_session_t::on_read, shared_from_this(), ph::_1))
     );
 }
 
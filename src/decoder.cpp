@@ -34,14 +34,175 @@
 
 using namespace cocaine::framework::detail;
 
+namespace {
+
+/// Reads a big-endian unsigned integer of the given width.
+std::uint64_t
+load(const unsigned char* data, size_t width) {
+    std::uint64_t value = 0;
+    for (size_t id = 0; id < width; ++id) {
+        value = (value << 8) | data[id];
+    }
+
+    return value;
+}
+
+/// Describes an object type header.
+struct header_t {
+    /// Size of the header itself, including the type byte.
+    size_t size;
+    /// Position and width of the length field within the header, if any.
+    size_t length_offset;
+    size_t length_width;
+    /// Whether the length means the number of bytes following the header, or the number of nested
+    /// objects.
+    enum { none, bytes, elements, pairs } kind;
+    /// Constant body size, e.g. for fixext types, added to the length if any.
+    size_t extra;
+};
+
+/// Describes the header of the object starting with the given type byte. Returns false for the
+/// never used type.
+bool
+describe(unsigned char type, header_t& header) {
+    if (type <= 0x7f || type >= 0xe0) {
+        // Positive and negative fixint.
+        header = header_t{1, 0, 0, header_t::none, 0};
+    } else if (type <= 0x8f) {
+        header = header_t{1, 0, 0, header_t::pairs, type & 0x0fu};
+    } else if (type <= 0x9f) {
+        header = header_t{1, 0, 0, header_t::elements, type & 0x0fu};
+    } else if (type <= 0xbf) {
+        header = header_t{1, 0, 0, header_t::bytes, type & 0x1fu};
+    } else {
+        switch (type) {
+        case 0xc0: case 0xc2: case 0xc3:
+            header = header_t{1, 0, 0, header_t::none, 0}; break;
+        case 0xc4: header = header_t{2, 1, 1, header_t::bytes, 0}; break;
+        case 0xc5: header = header_t{3, 1, 2, header_t::bytes, 0}; break;
+        case 0xc6: header = header_t{5, 1, 4, header_t::bytes, 0}; break;
+        case 0xc7: header = header_t{3, 1, 1, header_t::bytes, 0}; break;
+        case 0xc8: header = header_t{4, 1, 2, header_t::bytes, 0}; break;
+        case 0xc9: header = header_t{6, 1, 4, header_t::bytes, 0}; break;
+        case 0xca: header = header_t{5, 0, 0, header_t::none, 0}; break;
+        case 0xcb: header = header_t{9, 0, 0, header_t::none, 0}; break;
+        case 0xcc: case 0xd0:
+            header = header_t{2, 0, 0, header_t::none, 0}; break;
+        case 0xcd: case 0xd1:
+            header = header_t{3, 0, 0, header_t::none, 0}; break;
+        case 0xce: case 0xd2:
+            header = header_t{5, 0, 0, header_t::none, 0}; break;
+        case 0xcf: case 0xd3:
+            header = header_t{9, 0, 0, header_t::none, 0}; break;
+        case 0xd4: header = header_t{2, 0, 0, header_t::bytes, 1}; break;
+        case 0xd5: header = header_t{2, 0, 0, header_t::bytes, 2}; break;
+        case 0xd6: header = header_t{2, 0, 0, header_t::bytes, 4}; break;
+        case 0xd7: header = header_t{2, 0, 0, header_t::bytes, 8}; break;
+        case 0xd8: header = header_t{2, 0, 0, header_t::bytes, 16}; break;
+        case 0xd9: header = header_t{2, 1, 1, header_t::bytes, 0}; break;
+        case 0xda: header = header_t{3, 1, 2, header_t::bytes, 0}; break;
+        case 0xdb: header = header_t{5, 1, 4, header_t::bytes, 0}; break;
+        case 0xdc: header = header_t{3, 1, 2, header_t::elements, 0}; break;
+        case 0xdd: header = header_t{5, 1, 4, header_t::elements, 0}; break;
+        case 0xde: header = header_t{3, 1, 2, header_t::pairs, 0}; break;
+        case 0xdf: header = header_t{5, 1, 4, header_t::pairs, 0}; break;
+        default:
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+constexpr size_t frame_walker_t::MAX_DEPTH;
+
+frame_walker_t::frame_walker_t() {
+    reset();
+}
+
+size_t
+frame_walker_t::walk(const char* data, size_t size, std::error_code& ec) {
+    const auto bytes = reinterpret_cast<const unsigned char*>(data);
+
+    while (!stack.empty()) {
+        header_t header;
+        if (offset >= size) {
+            ec = error::insufficient_bytes;
+            return 0;
+        }
+
+        if (!describe(bytes[offset], header)) {
+            ec = error::parse_error;
+            return 0;
+        }
+
+        if (size - offset < header.size) {
+            ec = error::insufficient_bytes;
+            return 0;
+        }
+
+        const auto length = header.extra + load(bytes + offset + header.length_offset, header.length_width);
+
+        offset += header.size;
+        --stack.back();
+
+        switch (header.kind) {
+        case header_t::bytes:
+            // The body may be not received yet, it's checked on the next iteration or below.
+            offset += static_cast<size_t>(length);
+            break;
+        case header_t::elements:
+        case header_t::pairs:
+            if (stack.size() == MAX_DEPTH) {
+                ec = error::parse_error;
+                return 0;
+            }
+
+            stack.push_back(header.kind == header_t::pairs ? length * 2 : length);
+            break;
+        default:
+            break;
+        }
+
+        while (!stack.empty() && stack.back() == 0) {
+            stack.pop_back();
+        }
+    }
+
+    if (offset > size) {
+        ec = error::insufficient_bytes;
+        return 0;
+    }
+
+    return offset;
+}
+
+void
+frame_walker_t::reset() {
+    offset = 0;
+    stack.assign(1, 1);
+}
+
 size_t decoder_t::decode(const char* data, size_t size, message_type& message, std::error_code& ec) {
+    const auto frame = walker.walk(data, size, ec);
+    if (ec) {
+        if (ec == error::parse_error) {
+            walker.reset();
+        }
+        return 0;
+    }
+
+    walker.reset();
+
     size_t offset = 0;
 
+    // The frame is complete, so it is copied and parsed exactly once.
     msgpack::object object;
-    std::vector<char> buffer(size);
-    memcpy(buffer.data(), data, size);
+    std::vector<char> buffer(data, data + frame);
     std::unique_ptr<msgpack::zone> zone(new msgpack::zone{});
-    msgpack::unpack_return rv = msgpack::unpack(buffer.data(), size, &offset, &*zone, &object);
+    msgpack::unpack_return rv = msgpack::unpack(buffer.data(), frame, &offset, &*zone, &object);
 
     if(rv == msgpack::UNPACK_SUCCESS || rv == msgpack::UNPACK_EXTRA_BYTES) {
         std::vector<hpack::header_t> headers;
@@ -51,9 +212,14 @@ size_t decoder_t::decode(const char* data, size_t size, message_type& message, s
         error = error || object.via.array.ptr[0].type != msgpack::type::POSITIVE_INTEGER;
         error = error || object.via.array.ptr[1].type != msgpack::type::POSITIVE_INTEGER;
         error = error || object.via.array.ptr[2].type != msgpack::type::ARRAY;
-        if(object.via.array.size > 3) {
-            error = error || object.via.array.ptr[3].type != msgpack::type::ARRAY;
-            error = error || !hpack::msgpack_traits::unpack_vector(object.via.array.ptr[3], header_table, headers);
+        // Most of frames carry no headers at all, so there is no need to touch the header table.
+        if(!error && object.via.array.size > 3 && object.via.array.ptr[3].type == msgpack::type::ARRAY) {
+            if(object.via.array.ptr[3].via.array.size > 0) {
+                headers.reserve(object.via.array.ptr[3].via.array.size);
+                error = !hpack::msgpack_traits::unpack_vector(object.via.array.ptr[3], header_table, headers);
+            }
+        } else if(object.via.array.size > 3) {
+            error = true;
         }
         if(error) {
             ec = error::frame_format_error;
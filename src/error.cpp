@@ -58,6 +58,10 @@ struct service_category_t : public std::error_category {
             return "the specified service was not found in the locator";
         case static_cast<int>(cocaine::framework::error::version_mismatch):
             return "the service provides API with version different than required";
+        case static_cast<int>(cocaine::framework::error::connect_timeout):
+            return "the service was not connected in time";
+        case static_cast<int>(cocaine::framework::error::connect_queue_overflow):
+            return "too many requests are waiting for the service to be connected";
         default:
             return "unexpected service error";
         }
@@ -0,0 +1,221 @@
+/*
+    Copyright (c) 2015 Evgeny Safronov <division494@gmail.com>
+    Copyright (c) 2011-2015 Other contributors as noted in the AUTHORS file.
+    This file is part of Cocaine.
+    Cocaine is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+    Cocaine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU Lesser General Public License for more details.
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "cocaine/framework/detail/locations.hpp"
+
+#include <functional>
+#include <system_error>
+
+#include <asio/ip/tcp.hpp>
+
+#include "cocaine/framework/detail/log.hpp"
+#include "cocaine/framework/detail/net.hpp"
+
+namespace ph = std::placeholders;
+
+using namespace cocaine::framework;
+using namespace cocaine::framework::detail;
+
+/// Collects endpoints of all hosts being resolved, preserving the order of hosts.
+class locations_t::collector_t {
+public:
+    const std::shared_ptr<locations_t> parent;
+    asio::ip::tcp::resolver resolver;
+
+    std::mutex mutex;
+    std::size_t pending;
+    std::vector<std::vector<endpoint_type>> results;
+    std::error_code error;
+
+    collector_t(std::shared_ptr<locations_t> parent, loop_t& loop, std::size_t count) :
+        parent(std::move(parent)),
+        resolver(loop),
+        pending(count),
+        results(count)
+    {}
+
+    void
+    on_resolve(std::size_t id, const std::error_code& ec, asio::ip::tcp::resolver::iterator it) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (ec) {
+                CF_DBG("failed to resolve locator host '%s': %s",
+                    std::get<0>(parent->hosts[id]).c_str(), CF_EC(ec));
+
+                if (!error) {
+                    error = ec;
+                }
+            } else {
+                for (asio::ip::tcp::resolver::iterator end; it != end; ++it) {
+                    results[id].push_back(endpoint_cast(it->endpoint()));
+                }
+            }
+
+            if (--pending > 0) {
+                return;
+            }
+        }
+
+        std::vector<endpoint_type> endpoints;
+        for (const auto& result : results) {
+            endpoints.insert(endpoints.end(), result.begin(), result.end());
+        }
+
+        parent->on_resolve(std::move(endpoints), error);
+    }
+};
+
+locations_t::locations_t(std::vector<endpoint_type> endpoints) :
+    loop(nullptr),
+    interval(0),
+    endpoints_(std::move(endpoints)),
+    resolved(true),
+    resolving(false),
+    stopped(false)
+{}
+
+locations_t::locations_t(std::vector<host_type> hosts, loop_t& loop, boost::posix_time::seconds interval) :
+    hosts(std::move(hosts)),
+    loop(&loop),
+    interval(interval),
+    timer(new asio::deadline_timer(loop)),
+    resolved(false),
+    resolving(false),
+    stopped(false)
+{}
+
+locations_t::~locations_t() {}
+
+auto locations_t::endpoints() -> std::vector<endpoint_type> {
+    std::lock_guard<std::mutex> lock(mutex);
+    return endpoints_;
+}
+
+auto locations_t::get() -> task<std::vector<endpoint_type>>::future_type {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if (resolved) {
+        return make_ready_future<std::vector<endpoint_type>>::value(endpoints_);
+    }
+
+    task<std::vector<endpoint_type>>::promise_type promise;
+    auto future = promise.get_future();
+    queue.push_back(std::move(promise));
+
+    if (!resolving) {
+        resolving = true;
+        lock.unlock();
+        resolve();
+    }
+
+    return future;
+}
+
+void
+locations_t::stop() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    stopped = true;
+    if (timer) {
+        timer->cancel();
+    }
+}
+
+void
+locations_t::resolve() {
+    CF_DBG(">> resolving %llu locator hosts ...", CF_US(hosts.size()));
+
+    if (hosts.empty()) {
+        on_resolve({}, std::error_code());
+        return;
+    }
+
+    auto collector = std::make_shared<collector_t>(shared_from_this(), *loop, hosts.size());
+
+    for (std::size_t id = 0; id < hosts.size(); ++id) {
+        const asio::ip::tcp::resolver::query query(
+            std::get<0>(hosts[id]),
+            std::to_string(std::get<1>(hosts[id])),
+            asio::ip::tcp::resolver::query::numeric_service
+        );
+
+        collector->resolver.async_resolve(query,
+            std::bind(&collector_t::on_resolve, collector, id, ph::_1, ph::_2));
+    }
+}
+
+void
+locations_t::on_resolve(std::vector<endpoint_type> endpoints, const std::error_code& ec) {
+    std::deque<task<std::vector<endpoint_type>>::promise_type> queue;
+    std::vector<endpoint_type> result;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        resolving = false;
+
+        // Hosts, which failed to resolve, are skipped while there is at least one endpoint to
+        // connect to. Otherwise the previous endpoints are kept.
+        if (!endpoints.empty()) {
+            endpoints_ = std::move(endpoints);
+            resolved = true;
+        }
+
+        CF_DBG("<< resolving locator hosts - %s", resolved ? "done" : "failed");
+
+        queue.swap(this->queue);
+        result = endpoints_;
+
+        // Never resolved locations are resolved again lazily on the next request.
+        if (resolved && !stopped) {
+            schedule();
+        }
+    }
+
+    for (auto& promise : queue) {
+        if (result.empty()) {
+            promise.set_exception(std::system_error(ec ? ec : make_error_code(asio::error::host_not_found)));
+        } else {
+            promise.set_value(result);
+        }
+    }
+}
+
+void
+locations_t::schedule() {
+    auto self = shared_from_this();
+
+    timer->expires_from_now(interval);
+    timer->async_wait([self](const std::error_code& ec) {
+        if (ec) {
+            // Canceled.
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(self->mutex);
+
+            if (self->stopped || self->resolving) {
+                return;
+            }
+
+            self->resolving = true;
+        }
+
+        self->resolve();
+    });
+}
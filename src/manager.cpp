@@ -16,16 +16,24 @@
 
 #include "cocaine/framework/manager.hpp"
 
-#include <boost/lexical_cast.hpp>
+#include <chrono>
+#include <map>
+#include <mutex>
+
 #include <boost/optional/optional.hpp>
 #include <boost/thread/thread.hpp>
 
+#include <asio/deadline_timer.hpp>
+
 #include <cocaine/idl/logging.hpp>
 
 #include "cocaine/framework/scheduler.hpp"
 #include "cocaine/framework/service.hpp"
 
+#include "cocaine/framework/detail/locations.hpp"
 #include "cocaine/framework/detail/loop.hpp"
+#include "cocaine/framework/detail/metrics.hpp"
+#include "cocaine/framework/detail/resolver.hpp"
 #include "cocaine/framework/detail/runnable.hpp"
 
 namespace io {
@@ -59,14 +67,71 @@ public:
     }
 };
 
+/// Completes a warm-up after all of its services are either connected or failed.
+class warmup_t {
+    std::mutex mutex;
+    std::size_t pending;
+    std::exception_ptr error;
+    task<void>::promise_type promise;
+
+public:
+    explicit
+    warmup_t(std::size_t pending) :
+        pending(pending)
+    {}
+
+    auto
+    future() -> task<void>::future_type {
+        return promise.get_future();
+    }
+
+    void
+    done(task<void>::future_move_type future) {
+        std::exception_ptr error;
+
+        try {
+            future.get();
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (error && !this->error) {
+                this->error = error;
+            }
+
+            if (--pending > 0) {
+                return;
+            }
+        }
+
+        if (this->error) {
+            promise.set_exception(this->error);
+        } else {
+            promise.set_value();
+        }
+    }
+};
+
 } // namespace
 
 static const std::vector<session_t::endpoint_type> DEFAULT_LOCATIONS = {
     { boost::asio::ip::tcp::v6(), 10053 }
 };
 
+/// Default time an interned service without handles is kept before being evicted.
+static const std::chrono::milliseconds IDLE_TIMEOUT(60000);
+
+/// Interval between refreshes of locator endpoints resolved from host names.
+static const boost::posix_time::seconds LOCATIONS_REFRESH_INTERVAL(60);
+
 class cocaine::framework::service_manager_data {
 public:
+    /// Metrics of all services created by this manager. Must outlive the event loop.
+    metrics::registry_t registry;
+
     loop_t io;
     boost::optional<loop_t::work> work;
     event_loop_t event_loop;
@@ -74,82 +139,265 @@ public:
 
     service_manager_t::shutdown_policy_t shutdown_policy;
 
-    std::vector<session_t::endpoint_type> locations;
+    /// Policy services are created with.
+    reconnect_policy_t reconnect_policy;
+
+    /// Locator endpoints, either given or lazily resolved from host names.
+    std::shared_ptr<locations_t> locations;
+
+    /// Resolver used to warm services up.
+    std::shared_ptr<serialized_resolver_t> resolver;
 
     std::vector<boost::thread> threads;
 
     std::shared_ptr<service<io::log_tag>> logger;
 
-    service_manager_data(std::vector<session_t::endpoint_type> locations_) :
+    /// Trace logger shared by all services, so they don't start a flusher thread each.
+    boost::optional<internal_logger_t> trace;
+
+    class interned_t;
+
+    /// Services interned by their name and version.
+    std::shared_ptr<interned_t> services;
+
+    /// Constructs the manager data with the given locator endpoints, unless host names to resolve
+    /// them from are given.
+    service_manager_data(std::vector<session_t::endpoint_type> endpoints, std::vector<locations_t::host_type> hosts) :
         work(boost::optional<loop_t::work>(loop_t::work(io))),
-        event_loop(io),
+        event_loop(io, registry),
         scheduler(event_loop),
         shutdown_policy(service_manager_t::shutdown_policy_t::graceful),
-        locations(std::move(locations_)),
-        logger(std::make_shared<service<io::log_tag>>(internal_logger_t(), "logging", locations, scheduler))
+        locations(hosts.empty()
+            ? std::make_shared<locations_t>(std::move(endpoints))
+            : std::make_shared<locations_t>(std::move(hosts), io, LOCATIONS_REFRESH_INTERVAL)),
+        resolver(std::make_shared<serialized_resolver_t>(locations, scheduler)),
+        logger(new service<io::log_tag>(basic_service_t(
+            internal_logger_t(),
+            basic_service_t::make_impl("logging", cocaine::io::protocol<io::log_tag>::version::value, locations, scheduler,
+                reconnect_policy)
+        ))),
+        trace(internal_logger_t(logger)),
+        services(std::make_shared<interned_t>(io, registry))
     {}
 };
 
-namespace {
+/// Services interned by their name and version.
+///
+/// All handles of a service share a single reference to it, which records the time it was released
+/// together with the last handle. Services without handles are evicted by a timer after being idle
+/// for the given time, so their connections are closed even if no more handles are created.
+///
+/// \threadsafe
+class service_manager_data::interned_t : public std::enable_shared_from_this<interned_t> {
+public:
+    typedef std::tuple<std::string, unsigned int> key_type;
+
+private:
+    /// Owned by all handles of a service, notifies the manager when the last of them is released.
+    ///
+    /// It keeps the service alive on its own, because handles may outlive the manager.
+    struct handles_t {
+        std::weak_ptr<interned_t> parent;
+        key_type key;
+        std::shared_ptr<basic_service_t::impl> service;
+
+        ~handles_t() {
+            if (auto d = parent.lock()) {
+                d->on_release(key);
+            }
+        }
+    };
+
+    struct entry_t {
+        /// Keeps the service alive while it has no handles.
+        std::shared_ptr<basic_service_t::impl> service;
+        /// Reference shared by all handles of the service.
+        std::weak_ptr<basic_service_t::impl> handles;
+        /// Time the last handle was released.
+        std::chrono::steady_clock::time_point released;
+    };
+
+    std::mutex mutex;
+    std::map<key_type, entry_t> services;
+    std::chrono::milliseconds timeout;
+    asio::deadline_timer timer;
+    bool sweeping;
+
+    metrics::gauge_t& count;
 
-auto resolve(std::vector<std::tuple<std::string, std::uint16_t>> endpoints) ->
-    std::vector<service_manager_t::endpoint_type>
-{
-    std::vector<service_manager_t::endpoint_type> result;
+public:
+    explicit
+    interned_t(loop_t& loop, metrics::registry_t& registry) :
+        timeout(IDLE_TIMEOUT),
+        timer(loop),
+        sweeping(false),
+        count(registry.gauge("manager.services"))
+    {}
+
+    auto
+    idle_timeout() -> std::chrono::milliseconds {
+        std::lock_guard<std::mutex> lock(mutex);
+        return timeout;
+    }
+
+    void
+    idle_timeout(std::chrono::milliseconds timeout) {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->timeout = timeout;
+    }
 
-    boost::asio::io_service io_service;
-    boost::asio::ip::tcp::resolver resolver(io_service);
+    /// Returns a reference to the service with the given key shared by all its handles, creating
+    /// the service using the given factory if there is no such one.
+    template<class F>
+    auto
+    get(key_type key, F factory) -> std::shared_ptr<basic_service_t::impl> {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto& entry = services[key];
+        if (!entry.service) {
+            entry.service = factory();
+            count.inc();
+        }
+
+        if (auto handles = entry.handles.lock()) {
+            return handles;
+        }
+
+        auto owner = std::make_shared<handles_t>();
+        owner->parent = shared_from_this();
+        owner->key = std::move(key);
+        owner->service = entry.service;
+
+        std::shared_ptr<basic_service_t::impl> handles(owner, entry.service.get());
+        entry.handles = handles;
+        return handles;
+    }
 
-    auto inserter = std::back_inserter(result);
+    /// Evicts all services regardless of their handles and stops the eviction timer.
+    void
+    clear() {
+        decltype(services) services;
 
-    boost::asio::ip::tcp::resolver::iterator end;
-    std::string host;
-    std::uint16_t port;
-    for (const auto& endpoint : endpoints) {
-        std::tie(host, port) = endpoint;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
 
-        boost::asio::ip::tcp::resolver::query query(
-            host,
-            boost::lexical_cast<std::string>(port),
-            boost::asio::ip::tcp::resolver::query::flags::numeric_service
-        );
-        const auto it = resolver.resolve(query);
-        std::copy(it, end, inserter);
+            timer.cancel();
+            count.dec(static_cast<std::int64_t>(this->services.size()));
+            services.swap(this->services);
+        }
     }
 
-    return result;
-}
+private:
+    void
+    on_release(const key_type& key) {
+        std::lock_guard<std::mutex> lock(mutex);
 
-}  // namespace
+        auto it = services.find(key);
+        if (it == services.end() || !it->second.handles.expired()) {
+            // Either already evicted or a new handle has been created concurrently.
+            return;
+        }
+
+        it->second.released = std::chrono::steady_clock::now();
+        schedule(timeout);
+    }
+
+    /// \pre the mutex is locked.
+    void
+    schedule(std::chrono::milliseconds delay) {
+        if (sweeping) {
+            return;
+        }
+
+        sweeping = true;
+
+        std::weak_ptr<interned_t> self(shared_from_this());
+        timer.expires_from_now(boost::posix_time::milliseconds(delay.count()));
+        timer.async_wait([self](const std::error_code& ec) {
+            if (ec) {
+                // Canceled.
+                return;
+            }
+
+            if (auto d = self.lock()) {
+                d->sweep();
+            }
+        });
+    }
+
+    void
+    sweep() {
+        // Services are destroyed after unlocking, because it closes their sessions.
+        std::vector<std::shared_ptr<basic_service_t::impl>> evicted;
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        sweeping = false;
+
+        const auto now = std::chrono::steady_clock::now();
+        boost::optional<std::chrono::steady_clock::time_point> next;
+
+        for (auto it = services.begin(); it != services.end();) {
+            auto& entry = it->second;
+
+            if (!entry.handles.expired()) {
+                ++it;
+                continue;
+            }
+
+            const auto deadline = entry.released + timeout;
+            if (deadline <= now) {
+                evicted.push_back(std::move(entry.service));
+                it = services.erase(it);
+                count.dec();
+            } else {
+                if (!next || deadline < *next) {
+                    next = deadline;
+                }
+                ++it;
+            }
+        }
+
+        if (next) {
+            schedule(std::chrono::duration_cast<std::chrono::milliseconds>(*next - now) + std::chrono::milliseconds(1));
+        }
+    }
+};
 
 service_manager_t::service_manager_t() :
-    d(new service_manager_data(DEFAULT_LOCATIONS))
+    d(new service_manager_data(DEFAULT_LOCATIONS, {}))
 {
     const auto threads = boost::thread::hardware_concurrency();
     start(threads != 0 ? threads : 1);
 }
 
 service_manager_t::service_manager_t(unsigned int threads):
-    d(new service_manager_data(DEFAULT_LOCATIONS))
+    d(new service_manager_data(DEFAULT_LOCATIONS, {}))
 {
     start(threads);
 }
 
 service_manager_t::service_manager_t(std::vector<endpoint_type> entries, unsigned int threads):
-    d(new service_manager_data(std::move(entries)))
+    d(new service_manager_data(std::move(entries), {}))
 {
     start(threads);
 }
 
 service_manager_t::service_manager_t(std::vector<std::tuple<std::string, std::uint16_t>> entries, unsigned int threads) :
-    d(new service_manager_data(resolve(entries)))
+    d(new service_manager_data({}, std::move(entries)))
 {
     start(threads);
 }
 
 service_manager_t::~service_manager_t() {
     // Reset an own copy of a logger shared pointer to be able to join threads gracefully.
-    // Otherwise they will wait forever until all asynchronous operations completes.
+    // Otherwise they will wait forever until all asynchronous operations completes. The trace
+    // logger goes first, because it flushes pending records through the logging service.
+    // Interned services keep their sessions alive, so they are released as well.
+    d->services->clear();
+    d->resolver.reset();
+    d->locations->stop();
+    d->trace.reset();
     d->logger.reset();
 
     d->work.reset();
@@ -165,7 +413,7 @@ service_manager_t::~service_manager_t() {
 
 std::vector<session_t::endpoint_type>
 service_manager_t::endpoints() const {
-    return d->locations;
+    return d->locations->get().get();
 }
 
 void
@@ -184,11 +432,44 @@ service_manager_t::next() {
     return d->scheduler;
 }
 
+auto service_manager_t::warmup(std::vector<std::string> names) -> task<void>::future_type {
+    if (names.empty()) {
+        return make_ready_future<void>::value();
+    }
+
+    auto warmup = std::make_shared<warmup_t>(names.size());
+    auto future = warmup->future();
+
+    for (auto& name : names) {
+        d->resolver->resolve(name)
+            .then([this, name](task<serialized_resolver_t::result_type>::future_move_type future) -> task<void>::future_type {
+                const auto info = future.get();
+
+                // The service is already resolved, so there is no need to resolve it again while
+                // connecting.
+                auto service = intern(name, info.version);
+                return service.session->connect(info.endpoints);
+            })
+            .then(std::bind(&warmup_t::done, warmup, std::placeholders::_1));
+    }
+
+    return future;
+}
+
+auto service_manager_t::metrics() const -> metrics_snapshot_t {
+    return d->registry.snapshot();
+}
+
 std::shared_ptr<service<io::log_tag>>
 service_manager_t::logger() const {
     return d->logger;
 }
 
+internal_logger_t
+service_manager_t::trace_logger() const {
+    return *d->trace;
+}
+
 service_manager_t::shutdown_policy_t
 service_manager_t::shutdown_policy() const {
     return d->shutdown_policy;
@@ -198,3 +479,31 @@ void
 service_manager_t::shutdown_policy(shutdown_policy_t policy) {
     d->shutdown_policy = policy;
 }
+
+auto service_manager_t::idle_timeout() const -> std::chrono::milliseconds {
+    return d->services->idle_timeout();
+}
+
+void
+service_manager_t::idle_timeout(std::chrono::milliseconds timeout) {
+    d->services->idle_timeout(timeout);
+}
+
+reconnect_policy_t
+service_manager_t::reconnect_policy() const {
+    return d->reconnect_policy;
+}
+
+void
+service_manager_t::reconnect_policy(reconnect_policy_t policy) {
+    d->reconnect_policy = policy;
+}
+
+basic_service_t
+service_manager_t::intern(std::string name, unsigned int version) {
+    auto service = d->services->get(std::make_tuple(name, version), [&] {
+        return basic_service_t::make_impl(name, version, d->locations, d->scheduler, d->reconnect_policy);
+    });
+
+    return basic_service_t(trace_logger(), std::move(service));
+}
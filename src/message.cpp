@@ -26,24 +26,79 @@
 #include <msgpack/zone.hpp>
 
 #include <cocaine/hpack/header.hpp>
+#include <cocaine/hpack/static_table.hpp>
 
+#include "cocaine/framework/detail/log.hpp"
+
+using namespace cocaine;
 using namespace cocaine::framework;
 
+namespace {
+
+/// Extracts tracing headers with a single pass over the header list.
+auto extract_trace(const hpack::headers_t& headers) -> boost::optional<trace_headers_t> {
+    if (headers.empty()) {
+        return boost::none;
+    }
+
+    const hpack::header_t* trace_id = nullptr;
+    const hpack::header_t* span_id = nullptr;
+    const hpack::header_t* parent_id = nullptr;
+
+    for (const auto& header : headers) {
+        if (!trace_id && header.name() == hpack::headers::trace_id<>::name()) {
+            trace_id = &header;
+        } else if (!span_id && header.name() == hpack::headers::span_id<>::name()) {
+            span_id = &header;
+        } else if (!parent_id && header.name() == hpack::headers::parent_id<>::name()) {
+            parent_id = &header;
+        }
+    }
+
+    if (!trace_id || !span_id || !parent_id) {
+        return boost::none;
+    }
+
+    if (trace_id->value().empty() || span_id->value().empty() || parent_id->value().empty()) {
+        return boost::none;
+    }
+
+    try {
+        return trace_headers_t{
+            hpack::header::unpack<std::uint64_t>(trace_id->value()),
+            hpack::header::unpack<std::uint64_t>(span_id->value()),
+            hpack::header::unpack<std::uint64_t>(parent_id->value())
+        };
+    } catch (const std::exception& err) {
+        CF_DBG("could not decode tracing headers - %s", err.what());
+        return boost::none;
+    }
+}
+
+} // namespace
+
 class decoded_message::inner_t {
 public:
-    inner_t() {}
+    inner_t() :
+        extracted(true)
+    {}
 
     inner_t(msgpack::object _obj, std::unique_ptr<msgpack::zone> zone, std::vector<char>&& _storage, hpack::headers_t _headers) :
         obj(std::move(_obj)),
         zone(std::move(zone)),
         storage(std::move(_storage)),
-        headers(std::move(_headers))
+        headers(std::move(_headers)),
+        extracted(false)
     {}
 
     msgpack::object obj;
     std::unique_ptr<msgpack::zone> zone;
     std::vector<char> storage;
     hpack::headers_t headers;
+
+    /// Lazily extracted from headers.
+    boost::optional<trace_headers_t> trace;
+    bool extracted;
 };
 
 decoded_message::decoded_message(boost::none_t) :
@@ -72,6 +127,10 @@ auto decoded_message::type() const -> uint64_t {
     return d->obj.via.array.ptr[1].as<uint64_t>();
 }
 
+auto decoded_message::size() const noexcept -> std::size_t {
+    return d->storage.size();
+}
+
 auto decoded_message::args() const -> const msgpack::object& {
     return d->obj.via.array.ptr[2];
 }
@@ -79,3 +138,17 @@ auto decoded_message::args() const -> const msgpack::object& {
 auto decoded_message::meta() const noexcept -> const std::vector<hpack::header_t>& {
     return d->headers;
 }
+
+auto decoded_message::take_meta() noexcept -> std::vector<hpack::header_t> {
+    trace();
+    return std::move(d->headers);
+}
+
+auto decoded_message::trace() const noexcept -> const boost::optional<trace_headers_t>& {
+    if (!d->extracted) {
+        d->trace = extract_trace(d->headers);
+        d->extracted = true;
+    }
+
+    return d->trace;
+}
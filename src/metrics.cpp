@@ -0,0 +1,194 @@
+/*
+    Copyright (c) 2015 Evgeny Safronov <division494@gmail.com>
+    Copyright (c) 2011-2015 Other contributors as noted in the AUTHORS file.
+    This file is part of Cocaine.
+    Cocaine is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+    Cocaine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU Lesser General Public License for more details.
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "cocaine/framework/metrics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <boost/assert.hpp>
+
+#include "cocaine/framework/detail/metrics.hpp"
+
+using namespace cocaine::framework;
+using namespace cocaine::framework::detail::metrics;
+
+namespace {
+
+std::atomic<std::size_t> threads(0);
+
+} // namespace
+
+auto histogram_snapshot_t::quantile(double q) const -> std::uint64_t {
+    BOOST_ASSERT(q >= 0.0 && q <= 1.0);
+
+    if (count == 0) {
+        return 0;
+    }
+
+    const auto rank = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(count)));
+
+    std::uint64_t seen = 0;
+    for (const auto& bucket : buckets) {
+        seen += bucket.second;
+        if (seen >= rank) {
+            return bucket.first;
+        }
+    }
+
+    return buckets.back().first;
+}
+
+auto histogram_snapshot_t::mean() const -> double {
+    if (count == 0) {
+        return 0.0;
+    }
+
+    return static_cast<double>(sum) / static_cast<double>(count);
+}
+
+auto histogram_snapshot_t::max() const -> std::uint64_t {
+    if (buckets.empty()) {
+        return 0;
+    }
+
+    return buckets.back().first;
+}
+
+void
+metrics_snapshot_t::merge(const metrics_snapshot_t& other) {
+    for (const auto& counter : other.counters) {
+        counters[counter.first] = counter.second;
+    }
+
+    for (const auto& gauge : other.gauges) {
+        gauges[gauge.first] = gauge.second;
+    }
+
+    for (const auto& histogram : other.histograms) {
+        histograms[histogram.first] = histogram.second;
+    }
+}
+
+auto detail::metrics::thread_index() noexcept -> std::size_t {
+    static thread_local const std::size_t index = threads++;
+    return index;
+}
+
+constexpr unsigned int histogram_t::PRECISION;
+constexpr std::size_t histogram_t::SUBBUCKETS;
+constexpr std::size_t histogram_t::BUCKETS;
+
+histogram_t::histogram_t() {
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+auto histogram_t::snapshot() const -> histogram_snapshot_t {
+    histogram_snapshot_t result;
+    result.count = count.load();
+    result.sum = sum.load();
+
+    for (std::size_t id = 0; id < BUCKETS; ++id) {
+        const auto value = buckets[id].load(std::memory_order_relaxed);
+
+        if (value != 0) {
+            result.buckets.emplace_back(upper_bound(id), value);
+        }
+    }
+
+    return result;
+}
+
+auto histogram_t::upper_bound(std::size_t index) noexcept -> std::uint64_t {
+    if (index < SUBBUCKETS) {
+        return index;
+    }
+
+    const std::uint64_t shift = index / SUBBUCKETS - 1;
+    const std::uint64_t mantissa = index % SUBBUCKETS + SUBBUCKETS;
+
+    // The last bucket's bound overflows, so return the maximum value instead.
+    if (shift + PRECISION >= 63 && mantissa == 2 * SUBBUCKETS - 1) {
+        return std::numeric_limits<std::uint64_t>::max();
+    }
+
+    return ((mantissa + 1) << shift) - 1;
+}
+
+registry_t::registry_t() {}
+
+registry_t::~registry_t() {}
+
+auto registry_t::global() -> registry_t& {
+    static registry_t registry;
+    return registry;
+}
+
+auto registry_t::counter(const std::string& name) -> counter_t& {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto& counter = counters[name];
+    if (!counter) {
+        counter.reset(new counter_t);
+    }
+
+    return *counter;
+}
+
+auto registry_t::gauge(const std::string& name) -> gauge_t& {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto& gauge = gauges[name];
+    if (!gauge) {
+        gauge.reset(new gauge_t);
+    }
+
+    return *gauge;
+}
+
+auto registry_t::histogram(const std::string& name) -> histogram_t& {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto& histogram = histograms[name];
+    if (!histogram) {
+        histogram.reset(new histogram_t);
+    }
+
+    return *histogram;
+}
+
+auto registry_t::snapshot() const -> metrics_snapshot_t {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    metrics_snapshot_t result;
+
+    for (const auto& counter : counters) {
+        result.counters[counter.first] = counter.second->load();
+    }
+
+    for (const auto& gauge : gauges) {
+        result.gauges[gauge.first] = gauge.second->load();
+    }
+
+    for (const auto& histogram : histograms) {
+        result.histograms[histogram.first] = histogram.second->snapshot();
+    }
+
+    return result;
+}
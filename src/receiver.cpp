@@ -25,12 +25,24 @@ template<class Session>
 basic_receiver_t<Session>::basic_receiver_t(std::uint64_t id, std::shared_ptr<Session> session, std::shared_ptr<shared_state_t> state) :
     id(id),
     session(std::move(session)),
-    state(std::move(state))
+    state(std::move(state)),
+    revoked(false)
 {}
 
 template<class Session>
 basic_receiver_t<Session>::~basic_receiver_t() {
+    revoke();
+}
+
+template<class Session>
+void
+basic_receiver_t<Session>::revoke() {
+    if (revoked) {
+        return;
+    }
+
     CF_DBG("revoking ...");
+    revoked = true;
     session->revoke(id);
 }
 
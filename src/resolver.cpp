@@ -28,6 +28,7 @@
 #include "cocaine/framework/trace.hpp"
 
 #include "cocaine/framework/detail/basic_session.hpp"
+#include "cocaine/framework/detail/locations.hpp"
 #include "cocaine/framework/detail/log.hpp"
 #include "cocaine/framework/detail/net.hpp"
 
@@ -79,6 +80,14 @@ on_invoke(task<channel<io::locator::resolve>>::future_move_type future, std::sha
     }
 }
 
+task<void>::future_type
+on_locations(task<std::vector<resolver_t::endpoint_type>>::future_move_type future,
+             std::shared_ptr<framework::session_t> locator)
+{
+    CF_DBG(">> connecting to the locator ...");
+    return locator->connect(future.get());
+}
+
 task<channel<io::locator::resolve>>::future_type
 on_connect(task<void>::future_move_type future, std::shared_ptr<framework::session_t> locator, std::string name) {
     try {
@@ -96,19 +105,23 @@ on_connect(task<void>::future_move_type future, std::shared_ptr<framework::sessi
 } // namespace
 
 resolver_t::resolver_t(scheduler_t& scheduler) :
-    scheduler(scheduler)
-{
-    endpoints_.emplace_back(boost::asio::ip::tcp::v6(), 10053);
-}
+    scheduler(scheduler),
+    locations(std::make_shared<locations_t>(std::vector<endpoint_type>{{ boost::asio::ip::tcp::v6(), 10053 }}))
+{}
+
+resolver_t::resolver_t(scheduler_t& scheduler, std::shared_ptr<locations_t> locations) :
+    scheduler(scheduler),
+    locations(std::move(locations))
+{}
 
 resolver_t::~resolver_t() {}
 
 std::vector<resolver_t::endpoint_type> resolver_t::endpoints() const {
-    return endpoints_;
+    return locations->endpoints();
 }
 
 void resolver_t::endpoints(std::vector<resolver_t::endpoint_type> endpoints) {
-    endpoints_ = std::move(endpoints);
+    locations = std::make_shared<locations_t>(std::move(endpoints));
 }
 
 auto resolver_t::resolve(std::string name) -> task<resolver_t::result_t>::future_type {
@@ -117,21 +130,34 @@ auto resolver_t::resolve(std::string name) -> task<resolver_t::result_t>::future
     auto locator = std::make_shared<framework::session_t>(scheduler);
     locator->hard_shutdown(true);
 
-    CF_DBG(">> connecting to the locator ...");
-    return locator->connect(endpoints())
-        .then(scheduler, trace::wrap(trace_t::bind(&on_connect, ph::_1, locator, name)))
-        .then(scheduler, trace::wrap(trace_t::bind(&on_invoke, ph::_1, locator)))
-        .then(scheduler, trace::wrap(trace_t::bind(&on_resolve, ph::_1, locator, name)));
+    // Locations are usually known already, so there is no need to reschedule.
+    return locations->get()
+        .then(trace::wrap(trace::bind(&on_locations, ph::_1, locator)))
+        .then(scheduler, trace::wrap(trace::bind(&on_connect, ph::_1, locator, name)))
+        .then(scheduler, trace::wrap(trace::bind(&on_invoke, ph::_1, locator)))
+        .then(scheduler, trace::wrap(trace::bind(&on_resolve, ph::_1, locator, name)));
 }
 
+serialized_resolver_t::metrics_t::metrics_t(detail::metrics::registry_t& registry) :
+    requests(registry.counter("resolver.requests")),
+    coalesced(registry.counter("resolver.coalesced")),
+    errors(registry.counter("resolver.errors")),
+    latency(registry.histogram("resolver.latency"))
+{}
+
 serialized_resolver_t::serialized_resolver_t(std::vector<endpoint_type> endpoints, scheduler_t& scheduler) :
-    resolver(scheduler),
-    scheduler(scheduler)
-{
-    resolver.endpoints(std::move(endpoints));
-}
+    serialized_resolver_t(std::make_shared<locations_t>(std::move(endpoints)), scheduler)
+{}
+
+serialized_resolver_t::serialized_resolver_t(std::shared_ptr<locations_t> locations, scheduler_t& scheduler) :
+    resolver(scheduler, std::move(locations)),
+    scheduler(scheduler),
+    metrics(scheduler.loop().metrics)
+{}
 
 auto serialized_resolver_t::resolve(std::string name) -> task<result_type>::future_type {
+    metrics.requests.inc();
+
     std::unique_lock<std::mutex> lock(mutex);
 
     auto it = inprogress.find(name);
@@ -139,9 +165,13 @@ auto serialized_resolver_t::resolve(std::string name) -> task<result_type>::futu
         std::deque<task<result_type>::promise_type> queue;
         inprogress.insert(it, std::make_pair(name, queue));
         lock.unlock();
+
+        const auto start = std::chrono::steady_clock::now();
         return resolver.resolve(name)
-            .then(scheduler, trace::wrap(trace_t::bind(&serialized_resolver_t::notify_all, shared_from_this(), ph::_1, name)));
+            .then(scheduler, trace::wrap(trace::bind(&serialized_resolver_t::notify_all, shared_from_this(), ph::_1, name, start)));
     } else {
+        metrics.coalesced.inc();
+
         task<result_type>::promise_type promise;
         auto future = promise.get_future();
         it->second.push_back(std::move(promise));
@@ -150,7 +180,11 @@ auto serialized_resolver_t::resolve(std::string name) -> task<result_type>::futu
 }
 
 serialized_resolver_t::result_type
-serialized_resolver_t::notify_all(task<result_type>::future_move_type future, std::string name) {
+serialized_resolver_t::notify_all(task<result_type>::future_move_type future, std::string name,
+                                  std::chrono::steady_clock::time_point start)
+{
+    metrics.latency.record_since(start);
+
     std::lock_guard<std::mutex> lock(mutex);
 
     auto it = inprogress.find(name);
@@ -166,6 +200,8 @@ serialized_resolver_t::notify_all(task<result_type>::future_move_type future, st
         inprogress.erase(it);
         return result;
     } catch (const std::system_error& err) {
+        metrics.errors.inc();
+
         for (auto& promise : it->second) {
             promise.set_exception(err);
         }
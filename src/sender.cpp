@@ -34,3 +34,9 @@ task<void>::future_type
 basic_sender_t<Session>::send(io::encoder_t::message_type&& message) {
     return session->push(std::move(message));
 }
+
+template<class Session>
+task<void>::future_type
+basic_sender_t<Session>::send(io::encoder_t::message_type&& message, blob_t blob) {
+    return session->push(std::move(message), std::move(blob));
+}
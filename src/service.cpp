@@ -16,8 +16,18 @@
 
 #include "cocaine/framework/service.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <random>
+
+#include <asio/deadline_timer.hpp>
+
 #include "cocaine/framework/detail/basic_session.hpp"
+#include "cocaine/framework/detail/locations.hpp"
 #include "cocaine/framework/detail/log.hpp"
+#include "cocaine/framework/detail/loop.hpp"
+#include "cocaine/framework/detail/metrics.hpp"
 #include "cocaine/framework/detail/resolver.hpp"
 #include "cocaine/framework/trace.hpp"
 
@@ -28,6 +38,26 @@ using namespace cocaine::framework::detail;
 
 namespace {
 
+typedef std::chrono::steady_clock clock_type;
+
+boost::posix_time::milliseconds
+to_posix(std::chrono::milliseconds duration) {
+    return boost::posix_time::milliseconds(duration.count());
+}
+
+/// Errors reported by the Locator or by the service itself are not healed by reconnecting, unlike
+/// network ones.
+bool
+permanent(const std::exception_ptr& error) {
+    try {
+        std::rethrow_exception(error);
+    } catch (const error_t&) {
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
 task<void>::future_type
 on_resolve(task<resolver_t::result_t>::future_move_type future, uint version, std::shared_ptr<session_t> session) {
     auto info = future.get();
@@ -39,11 +69,18 @@ on_resolve(task<resolver_t::result_t>::future_move_type future, uint version, st
 }
 
 void
-on_connect(task<void>::future_move_type future) {
+on_connect(task<void>::future_move_type future,
+           detail::metrics::histogram_t& latency,
+           detail::metrics::counter_t& errors,
+           std::chrono::steady_clock::time_point start)
+{
+    latency.record_since(start);
+
     try {
         future.get();
         CF_DBG("<< connected");
     } catch (const std::exception& err) {
+        errors.inc();
         CF_DBG("<< failed to connect: %s", err.what());
         throw;
     }
@@ -51,29 +88,370 @@ on_connect(task<void>::future_move_type future) {
 
 } // namespace
 
-class basic_service_t::impl {
+/// Connects the service, throttling connection attempts after failures.
+///
+/// Requests issued while the service is being connected are parked until the connection attempt
+/// succeeds or their deadline expires. After a failed attempt the next one is delayed with an
+/// exponential backoff with jitter, so a service, which is down, is not hammered by its clients.
+/// An attempt, which outlives all requests waiting for it, is abandoned and treated as a failed one.
+class basic_service_t::impl : public std::enable_shared_from_this<basic_service_t::impl> {
 public:
+    enum class state_t {
+        /// There is no connection attempt in progress, the next request starts one immediately.
+        idle,
+        /// A connection attempt is in progress.
+        connecting,
+        /// The last attempt has failed, the next one is delayed.
+        backoff
+    };
+
+    /// A request waiting for the service to be connected.
+    struct parked_t {
+        task<void>::promise_type promise;
+        clock_type::time_point deadline;
+    };
+
     std::string name;
     uint version;
     scheduler_t& scheduler;
+    const reconnect_policy_t policy;
     std::shared_ptr<serialized_resolver_t> resolver;
+    std::shared_ptr<session_t> session;
     std::mutex mutex;
 
-    impl(std::string name, uint version, endpoints_t locations, scheduler_t& scheduler) :
+    state_t state;
+    /// Incremented for each connection attempt, so the result of an abandoned one is ignored.
+    std::uint64_t generation;
+    /// Number of consecutive failed attempts.
+    std::uint32_t attempts;
+    /// Error of the last failed attempt.
+    std::exception_ptr error;
+    clock_type::time_point retry_at;
+    asio::deadline_timer retry;
+    bool retrying;
+
+    /// Parked requests ordered by their deadlines, which follow the order of parking, because all
+    /// of them wait for the same time.
+    std::deque<parked_t> parked;
+    /// Single timer armed for the earliest deadline of parked requests.
+    asio::deadline_timer expiry;
+    bool expiring;
+
+    std::mt19937 random;
+
+    struct {
+        detail::metrics::counter_t& connects;
+        detail::metrics::counter_t& errors;
+        detail::metrics::histogram_t& latency;
+    } metrics;
+
+    impl(std::string name, uint version, std::shared_ptr<locations_t> locations, scheduler_t& scheduler,
+         reconnect_policy_t policy) :
         name(std::move(name)),
         version(version),
         scheduler(scheduler),
-        resolver(std::make_shared<serialized_resolver_t>(std::move(locations), scheduler))
+        policy(policy),
+        resolver(std::make_shared<serialized_resolver_t>(std::move(locations), scheduler)),
+        session(std::make_shared<session_t>(scheduler)),
+        state(state_t::idle),
+        generation(0),
+        attempts(0),
+        retry(scheduler.loop().loop),
+        retrying(false),
+        expiry(scheduler.loop().loop),
+        expiring(false),
+        random(std::random_device()()),
+        metrics{
+            scheduler.loop().metrics.counter("service.connects"),
+            scheduler.loop().metrics.counter("service.connect.errors"),
+            scheduler.loop().metrics.histogram("service.connect.latency")
+        }
     {}
+
+    auto
+    connect() -> task<void>::future_type {
+        const auto now = clock_type::now();
+
+        std::unique_lock<std::mutex> lock(mutex);
+
+        if (state == state_t::backoff && now + policy.park_timeout < retry_at) {
+            // There is no chance to connect in time, so fail fast instead of waiting for nothing.
+            return make_ready_future<void>::error(error);
+        }
+
+        if (parked.size() >= policy.park_limit) {
+            return make_ready_future<void>::error(error_t(error::connect_queue_overflow,
+                "too many requests are waiting for the '" + name + "' service to be connected"));
+        }
+
+        auto future = park(now + policy.park_timeout);
+
+        switch (state) {
+        case state_t::idle:
+            break;
+        case state_t::connecting:
+            return future;
+        case state_t::backoff:
+            if (now < retry_at) {
+                schedule();
+                return future;
+            }
+            break;
+        }
+
+        state = state_t::connecting;
+        const auto id = ++generation;
+        lock.unlock();
+
+        attempt(id);
+        return future;
+    }
+
+private:
+    /// \pre the mutex is locked.
+    auto
+    park(clock_type::time_point deadline) -> task<void>::future_type {
+        parked.emplace_back();
+
+        auto& entry = parked.back();
+        entry.deadline = deadline;
+
+        if (!expiring) {
+            expire_at(deadline);
+        }
+
+        return entry.promise.get_future();
+    }
+
+    /// \pre the mutex is locked and the timer is not armed.
+    void
+    expire_at(clock_type::time_point deadline) {
+        expiring = true;
+
+        expiry.expires_from_now(to_posix(
+            std::chrono::duration_cast<std::chrono::milliseconds>(deadline - clock_type::now())
+        ));
+
+        std::weak_ptr<impl> self(shared_from_this());
+        expiry.async_wait([self](const std::error_code& ec) {
+            if (ec) {
+                // Canceled.
+                return;
+            }
+
+            if (auto d = self.lock()) {
+                d->on_expired();
+            }
+        });
+    }
+
+    /// \pre the mutex is locked and the next attempt is delayed.
+    void
+    schedule() {
+        if (retrying) {
+            return;
+        }
+
+        retrying = true;
+
+        retry.expires_from_now(to_posix(
+            std::chrono::duration_cast<std::chrono::milliseconds>(retry_at - clock_type::now())
+        ));
+
+        std::weak_ptr<impl> self(shared_from_this());
+        retry.async_wait([self](const std::error_code& ec) {
+            if (ec) {
+                return;
+            }
+
+            if (auto d = self.lock()) {
+                d->on_retry();
+            }
+        });
+    }
+
+    /// \pre the state is set to connecting.
+    void
+    attempt(std::uint64_t id) {
+        CF_DBG(">> connection attempt ...");
+        metrics.connects.inc();
+
+        std::weak_ptr<impl> self(shared_from_this());
+
+        resolver->resolve(name)
+            .then(trace::wrap(trace::bind(&::on_resolve, ph::_1, version, session)))
+            .then(trace::wrap(trace::bind(&::on_connect,
+                ph::_1,
+                std::ref(metrics.latency),
+                std::ref(metrics.errors),
+                clock_type::now()
+            )))
+            .then(trace::wrap([self, id](task<void>::future_move_type future) {
+                if (auto d = self.lock()) {
+                    d->on_attempt(id, future);
+                }
+            }));
+    }
+
+    void
+    on_attempt(std::uint64_t id, task<void>::future_move_type future) {
+        std::exception_ptr error;
+
+        try {
+            future.get();
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        std::vector<task<void>::promise_type> done;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (id != generation || state != state_t::connecting) {
+                CF_DBG("<< abandoned connection attempt completed");
+                return;
+            }
+
+            if (error) {
+                fail(error);
+
+                // Requests, which can not wait for the next attempt, are failed with this one.
+                // Their deadlines are the earliest ones, so they are at the front.
+                const auto fatal = permanent(error);
+                while (!parked.empty() && (fatal || parked.front().deadline < retry_at)) {
+                    done.push_back(std::move(parked.front().promise));
+                    parked.pop_front();
+                }
+
+                if (!parked.empty()) {
+                    schedule();
+                }
+            } else {
+                state = state_t::idle;
+                attempts = 0;
+                this->error = nullptr;
+
+                for (auto& entry : parked) {
+                    done.push_back(std::move(entry.promise));
+                }
+                parked.clear();
+            }
+        }
+
+        for (auto& promise : done) {
+            if (error) {
+                promise.set_exception(error);
+            } else {
+                promise.set_value();
+            }
+        }
+    }
+
+    void
+    on_retry() {
+        std::uint64_t id;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            retrying = false;
+
+            if (state != state_t::backoff || parked.empty()) {
+                return;
+            }
+
+            state = state_t::connecting;
+            id = ++generation;
+        }
+
+        attempt(id);
+    }
+
+    void
+    on_expired() {
+        std::vector<task<void>::promise_type> expired;
+        std::exception_ptr error;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            expiring = false;
+
+            const auto now = clock_type::now();
+            while (!parked.empty() && parked.front().deadline <= now) {
+                expired.push_back(std::move(parked.front().promise));
+                parked.pop_front();
+            }
+
+            // Requests parked after the timer was armed, or after the ones it was armed for were
+            // completed, wait for the next deadline.
+            if (!parked.empty()) {
+                expire_at(parked.front().deadline);
+            } else if (state == state_t::connecting) {
+                // Nobody waits for the attempt anymore, but it may hang forever. Abandon it, so the
+                // next request starts a new one after the backoff.
+                ++generation;
+                fail(std::make_exception_ptr(error_t(error::connect_timeout,
+                    "the '" + name + "' service was not connected in time")));
+            }
+
+            // The last attempt error tells much more than the timeout itself.
+            error = this->error;
+        }
+
+        for (auto& promise : expired) {
+            if (error) {
+                promise.set_exception(error);
+            } else {
+                promise.set_exception(error_t(error::connect_timeout,
+                    "the '" + name + "' service was not connected in time"));
+            }
+        }
+    }
+
+    /// Moves to the backoff state after the current attempt has failed with the given error.
+    ///
+    /// \pre the mutex is locked.
+    void
+    fail(std::exception_ptr error) {
+        state = state_t::backoff;
+        ++attempts;
+        this->error = std::move(error);
+        retry_at = clock_type::now() + backoff();
+
+        CF_DBG("<< connection attempt %u failed, retrying in %lld ms", attempts,
+            static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(retry_at - clock_type::now()).count()));
+    }
+
+    /// \pre the mutex is locked.
+    auto
+    backoff() -> std::chrono::milliseconds {
+        const auto exponent = std::min<std::uint32_t>(attempts - 1, 20);
+        const auto delay = std::min(policy.backoff_min.count() << exponent, policy.backoff_max.count());
+
+        // Only the upper half of the delay is randomized, so clients, which have failed together,
+        // spread their attempts while still backing off.
+        std::uniform_int_distribution<std::chrono::milliseconds::rep> distribution(delay / 2, delay);
+        return std::chrono::milliseconds(distribution(random));
+    }
 };
 
 basic_service_t::basic_service_t(internal_logger_t logger_, std::string name, uint version, endpoints_t locations, scheduler_t& scheduler) :
-    d(new impl(std::move(name), version, std::move(locations), scheduler)),
-    session(std::make_shared<session_t>(scheduler)),
+    d(make_impl(std::move(name), version, std::make_shared<locations_t>(std::move(locations)), scheduler,
+                reconnect_policy_t())),
+    session(d->session),
     scheduler(scheduler),
     logger(std::move(logger_))
 {}
 
+basic_service_t::basic_service_t(internal_logger_t logger_, std::shared_ptr<impl> d_) :
+    d(std::move(d_)),
+    session(d->session),
+    scheduler(d->scheduler),
+    logger(std::move(logger_))
+{}
+
 basic_service_t::basic_service_t(basic_service_t&& other) :
     d(std::move(other.d)),
     session(std::move(other.session)),
@@ -83,6 +461,13 @@ basic_service_t::basic_service_t(basic_service_t&& other) :
 
 basic_service_t::~basic_service_t() {}
 
+auto basic_service_t::make_impl(std::string name, uint version, std::shared_ptr<locations_t> locations,
+                                scheduler_t& scheduler, reconnect_policy_t policy) ->
+    std::shared_ptr<impl>
+{
+    return std::make_shared<impl>(std::move(name), version, std::move(locations), scheduler, policy);
+}
+
 const std::string&
 basic_service_t::name() const noexcept {
     return d->name;
@@ -102,8 +487,6 @@ basic_service_t::connect() {
     CF_CTX("SC");
     CF_DBG(">> connecting ...");
 
-    std::lock_guard<std::mutex> lock(d->mutex);
-
     // Internally the session manages with connection state itself. On any network error it
     // should drop its internal state and return false.
     if (session->connected()) {
@@ -111,9 +494,7 @@ basic_service_t::connect() {
         return make_ready_future<void>::value();
     }
 
-    return d->resolver->resolve(d->name)
-        .then(trace::wrap(trace_t::bind(&::on_resolve, ph::_1, d->version, session)))
-        .then(trace::wrap(trace_t::bind(&::on_connect, ph::_1)));
+    return d->connect();
 }
 
 boost::optional<session_t::endpoint_type>
@@ -115,7 +115,7 @@ auto session<BasicSession>::connect(const std::vector<session::endpoint_type>& e
     auto future = promise->get_future();
 
     d->sess->connect(endpoints)
-        .then(d->scheduler, trace::wrap(trace_t::bind(&impl::on_connect, d, ph::_1, promise)));
+        .then(d->scheduler, trace::wrap(trace::bind(&impl::on_connect, d, ph::_1, promise)));
 
     return future;
 }
@@ -143,5 +143,26 @@ auto session<BasicSession>::invoke(encode_callback_t encode_callback)
     return d->sess->invoke(std::move(encode_callback));
 }
 
+template<class BasicSession>
+auto session<BasicSession>::invoke_many(std::size_t count, encode_callback_t encode_callback)
+    -> task<std::vector<basic_invoke_result>>::future_type
+{
+    return d->sess->invoke_many(count, std::move(encode_callback));
+}
+
+template<class BasicSession>
+auto session<BasicSession>::invoke_mute(encode_callback_t encode_callback)
+    -> task<void>::future_type
+{
+    return d->sess->invoke_mute(std::move(encode_callback));
+}
+
+template<class BasicSession>
+auto session<BasicSession>::invoke_mute_many(std::size_t count, encode_callback_t encode_callback)
+    -> task<void>::future_type
+{
+    return d->sess->invoke_mute_many(count, std::move(encode_callback));
+}
+
 #include "cocaine/framework/detail/basic_session.hpp"
 template class cocaine::framework::session<basic_session_t>;
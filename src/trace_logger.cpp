@@ -15,75 +15,174 @@
 #include <cocaine/traits/attributes.hpp>
 #include <cocaine/locked_ptr.hpp>
 
-#include <asio/io_service.hpp>
+#include "cocaine/framework/detail/bounded_queue.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
+#include <mutex>
 #include <thread>
+#include <tuple>
+#include <vector>
+
 namespace cocaine { namespace framework {
 namespace {
-    void
-    run_asio(asio::io_service& loop) {
-        CF_DBG("Starting loop...");
-        loop.run();
-        CF_DBG("Stopped loop");
-    }
+    /// Maximum number of records waiting to be sent. Must be a power of two.
+    const std::size_t QUEUE_CAPACITY = 4096;
 
-    class log_handler_t :
-    public std::enable_shared_from_this<log_handler_t> {
-    public:
-        log_handler_t(std::shared_ptr<framework::service<io::log_tag>> _logger, std::string _message, blackhole::attributes_t _attributes) :
-            logger(std::move(_logger)),
-            message(std::move(_message)),
-            attributes(std::move(_attributes))
-        {
-            attributes.push_back({"real_timestamp", current_time()});
-        }
+    /// Number of queued records which wakes the flusher up before the flush interval expires.
+    const std::size_t FLUSH_BATCH = 128;
 
-        void
-        operator()() {
-            CF_DBG("SENDING %s ", message.c_str());
-            logger->invoke<io::log::emit>(
-                logging::info,
-                std::string("app/trace"),
-                std::move(message),
-                std::move(attributes)
-            );
-            CF_DBG("SENT %s ", message.c_str());
-        }
+    const std::chrono::milliseconds FLUSH_INTERVAL(100);
 
-        static
-        uint64_t
-        current_time() {
-            return std::chrono::duration_cast<std::chrono::microseconds>(
-                        std::chrono::system_clock::now().time_since_epoch()
-                   ).count();
-        }
+    const std::string SOURCE("app/trace");
 
-    private:
-        std::shared_ptr<framework::service<io::log_tag>> logger;
+    struct record_t {
         std::string message;
         blackhole::attributes_t attributes;
     };
+
+    typedef std::tuple<logging::priorities, std::string, std::string, blackhole::attributes_t> emit_args_t;
+
+    /// Shared with pending writes, which may complete after the logger is destroyed.
+    struct counters_t {
+        std::atomic<std::uint64_t> queued;
+        std::atomic<std::uint64_t> sent;
+        std::atomic<std::uint64_t> dropped;
+
+        counters_t() :
+            queued(0),
+            sent(0),
+            dropped(0)
+        {}
+    };
+
+    void
+    on_flushed(task<void>::future_move_type future, std::shared_ptr<counters_t> counters, std::size_t count) {
+        try {
+            future.get();
+            counters->sent += count;
+        } catch (const std::exception& err) {
+            CF_DBG("failed to send %llu trace log records: %s", static_cast<unsigned long long>(count), err.what());
+            counters->dropped += count;
+        }
+    }
+
+    uint64_t
+    current_time() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()
+               ).count();
+    }
 }
 
 class internal_logger_t::impl {
 public:
     impl(std::shared_ptr<service<io::log_tag>> logger_service) :
         logger(std::move(logger_service)),
-        loop(),
-        work(boost::optional<asio::io_service::work>(asio::io_service::work(loop))),
-        chamber(run_asio, std::ref(loop))
+        queue(QUEUE_CAPACITY),
+        counters(std::make_shared<counters_t>()),
+        stopped(false),
+        flusher(&impl::run, this)
     {}
 
     ~impl() {
-        work.reset();
-        chamber.join();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+        }
+
+        cv.notify_one();
+        flusher.join();
+    }
+
+    void
+    push(record_t record) {
+        ++counters->queued;
+
+        if (const auto count = queue.force_push(record)) {
+            counters->dropped += count;
+        }
+
+        // Wake the flusher up without locking. A lost notification only delays the flush until
+        // the next interval.
+        if (queue.size() >= FLUSH_BATCH) {
+            cv.notify_one();
+        }
     }
 
     std::shared_ptr<framework::service<io::log_tag>> logger;
-    asio::io_service loop;
-    boost::optional<asio::io_service::work> work;
-    std::thread chamber;
+
+    detail::bounded_queue_t<record_t> queue;
+
+    std::shared_ptr<counters_t> counters;
+
+private:
+    void
+    run() {
+        CF_DBG("Starting trace log flusher...");
+
+        std::vector<record_t> batch;
+        batch.reserve(FLUSH_BATCH);
+
+        while (true) {
+            bool stop;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait_for(lock, FLUSH_INTERVAL, [&] {
+                    return stopped || queue.size() >= FLUSH_BATCH;
+                });
+                stop = stopped;
+            }
+
+            // Drain the queue in batches, including records pushed while flushing.
+            while (true) {
+                record_t record;
+                while (batch.size() < FLUSH_BATCH && queue.pop(record)) {
+                    batch.push_back(std::move(record));
+                }
+
+                if (batch.empty()) {
+                    break;
+                }
+
+                flush(batch);
+                batch.clear();
+            }
+
+            if (stop) {
+                break;
+            }
+        }
+
+        CF_DBG("Stopped trace log flusher");
+    }
+
+    /// Sends the batch as emit events encoded into a single buffer and written at once.
+    ///
+    /// Records are accounted as either sent or dropped after the write completes.
+    void
+    flush(std::vector<record_t>& batch) {
+        CF_DBG("SENDING %llu records", static_cast<unsigned long long>(batch.size()));
+
+        std::vector<emit_args_t> args;
+        args.reserve(batch.size());
+        for (auto& record : batch) {
+            args.emplace_back(logging::info, SOURCE, std::move(record.message), std::move(record.attributes));
+        }
+
+        namespace ph = std::placeholders;
+
+        logger->invoke_many<io::log::emit>(std::move(args))
+            .then(std::bind(&on_flushed, ph::_1, counters, batch.size()));
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopped;
+
+    std::thread flusher;
 };
 
 void
@@ -91,11 +190,26 @@ internal_logger_t::log(std::string message) {
     if(!d) {
         return;
     }
-    //std::bind here is intentional. We don't want to pass trace there.
-    d->loop.post(std::bind(
-        &log_handler_t::operator(),
-        std::make_shared<log_handler_t>(d->logger, std::move(message), trace_t::current().attributes<blackhole::attributes_t>())
-    ));
+
+    // Nothing to log for untraced or unsampled requests, so do not even build attributes.
+    if(trace_t::current().empty()) {
+        return;
+    }
+
+    record_t record{std::move(message), trace_t::current().attributes<blackhole::attributes_t>()};
+    record.attributes.push_back({"real_timestamp", current_time()});
+
+    d->push(std::move(record));
+}
+
+internal_logger_t::stats_t
+internal_logger_t::stats() const {
+    if(!d) {
+        return stats_t{0, 0, 0};
+    }
+
+    const auto& counters = *d->counters;
+    return stats_t{counters.queued.load(), counters.sent.load(), counters.dropped.load()};
 }
 
 internal_logger_t::internal_logger_t(std::shared_ptr<service<io::log_tag>> logger_service) :
@@ -107,6 +221,10 @@ internal_logger_t::internal_logger_t():
     d(nullptr)
 {}
 
+internal_logger_t::internal_logger_t(const internal_logger_t& other) :
+    d(other.d)
+{}
+
 internal_logger_t::internal_logger_t(internal_logger_t&& other) :
     d(std::move(other.d))
 {
@@ -16,7 +16,10 @@
 
 #include "cocaine/framework/worker.hpp"
 
+#include <array>
 #include <csignal>
+#include <string>
+#include <vector>
 
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
@@ -26,6 +29,8 @@
 #include <asio/local/stream_protocol.hpp>
 #include <asio/connect.hpp>
 
+#include <msgpack.hpp>
+
 #include "cocaine/framework/error.hpp"
 #include "cocaine/framework/forwards.hpp"
 #include "cocaine/framework/manager.hpp"
@@ -57,10 +62,61 @@ parse_endpoint(const std::string& endpoint) {
     return std::make_tuple(endpoint.substr(0, pos), endpoint.substr(pos + 1));
 }
 
+/// Quantiles reported for each histogram.
+const std::array<std::pair<const char*, double>, 4> QUANTILES = {{
+    { "p50", 0.5 }, { "p90", 0.9 }, { "p99", 0.99 }, { "p999", 0.999 }
+}};
+
+/// Packs the given snapshot as a msgpack map with "counters", "gauges" and "histograms" keys.
+///
+/// Histograms are reduced to their count, sum, mean, max and quantiles, because raw buckets are
+/// useless for monitoring systems.
+std::string
+pack(const metrics_snapshot_t& snapshot) {
+    msgpack::sbuffer buffer;
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+
+    packer.pack_map(3);
+
+    packer << std::string("counters");
+    packer.pack_map(static_cast<unsigned int>(snapshot.counters.size()));
+    for (const auto& counter : snapshot.counters) {
+        packer << counter.first << counter.second;
+    }
+
+    packer << std::string("gauges");
+    packer.pack_map(static_cast<unsigned int>(snapshot.gauges.size()));
+    for (const auto& gauge : snapshot.gauges) {
+        packer << gauge.first << gauge.second;
+    }
+
+    packer << std::string("histograms");
+    packer.pack_map(static_cast<unsigned int>(snapshot.histograms.size()));
+    for (const auto& item : snapshot.histograms) {
+        const auto& histogram = item.second;
+
+        packer << item.first;
+        packer.pack_map(static_cast<unsigned int>(4 + QUANTILES.size()));
+        packer << std::string("count") << histogram.count;
+        packer << std::string("sum") << histogram.sum;
+        packer << std::string("mean") << histogram.mean();
+        packer << std::string("max") << histogram.max();
+
+        for (const auto& quantile : QUANTILES) {
+            packer << std::string(quantile.first) << histogram.quantile(quantile.second);
+        }
+    }
+
+    return std::string(buffer.data(), buffer.size());
+}
+
 } // namespace
 
 class worker_t::impl {
 public:
+    /// Metrics of the worker session and the userland executor. Must outlive the event loop.
+    detail::metrics::registry_t registry;
+
     /// Control event loop.
     detail::loop_t io;
     event_loop_t loop;
@@ -79,10 +135,10 @@ public:
     std::shared_ptr<worker_session_t> session;
 
     impl(options_t options, std::vector<session_t::endpoint_type> entries) :
-        loop(io),
+        loop(io, registry),
         scheduler(loop),
         options(std::move(options)),
-        executor(),
+        executor(this->options.threads(), registry),
         manager(std::move(entries), 1)
     {
         token_manager = token_manager_t::make(io, manager, this->options);
@@ -147,13 +203,35 @@ worker_t::fallback(fallback_type handler) {
     d->dispatch.fallback(std::move(handler));
 }
 
+auto worker_t::metrics() const -> metrics_snapshot_t {
+    auto result = d->manager.metrics();
+    result.merge(d->registry.snapshot());
+    return result;
+}
+
+void
+worker_t::expose_metrics(std::string event) {
+    on(std::move(event), [this](worker::sender tx, worker::receiver) {
+        const auto packed = pack(metrics());
+
+        // Wait for the reply to be written like any other handler does, so a write error is
+        // thrown from the handler instead of being lost.
+        tx.write_and_close(std::vector<boost::string_ref>{ packed }).get();
+    });
+}
+
 auto worker_t::options() const -> const options_t& {
     return d->options;
 }
 
 int worker_t::run() {
     auto executor = std::bind(&detail::worker::executor_t::operator(), std::ref(d->executor), ph::_1);
-    d->session.reset(new worker_session_t(d->dispatch, d->scheduler, executor));
+    d->session.reset(new worker_session_t(
+        d->dispatch,
+        d->scheduler,
+        executor,
+        trace::sampler_t(d->options.trace_sample_rate())
+    ));
     d->session->connect(d->options.endpoint);
     d->session->run(d->options.uuid);
 
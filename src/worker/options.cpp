@@ -17,9 +17,12 @@
 #include "cocaine/framework/worker/options.hpp"
 
 #include <array>
+#include <cstdlib>
 #include <iostream>
+#include <limits>
 
 #include <boost/program_options.hpp>
+#include <boost/thread/thread.hpp>
 
 #include "defaults.hpp"
 
@@ -28,6 +31,8 @@ using namespace cocaine::framework;
 namespace details {
     constexpr auto KEY_ENV_TOKEN_TYPE = "COCAINE_APP_TOKEN_TYPE";
     constexpr auto KEY_ENV_TOKEN_BODY = "COCAINE_APP_TOKEN_BODY";
+    constexpr auto KEY_ENV_TRACE_SAMPLE_RATE = "COCAINE_FRAMEWORK_TRACE_SAMPLE_RATE";
+    constexpr auto KEY_ENV_WORKER_THREADS = "COCAINE_FRAMEWORK_WORKER_THREADS";
 }
 
 namespace {
@@ -122,6 +127,35 @@ options_t::options_t(int argc, char** argv)
     } else {
         other["token_body"] = std::string();
     }
+
+    double sample_rate = 1.0;
+    if ((env_val = std::getenv(::details::KEY_ENV_TRACE_SAMPLE_RATE)) != nullptr) {
+        char* end = nullptr;
+        sample_rate = std::strtod(env_val, &end);
+
+        if (end == env_val || *end != '\0' || sample_rate < 0.0 || sample_rate > 1.0) {
+            std::cerr << "ERROR: the trace sample rate must be a number in [0.0, 1.0] range"
+                      << std::endl;
+            std::exit(1);
+        }
+    }
+
+    other["trace_sample_rate"] = sample_rate;
+
+    unsigned int threads = boost::thread::hardware_concurrency();
+    if ((env_val = std::getenv(::details::KEY_ENV_WORKER_THREADS)) != nullptr) {
+        char* end = nullptr;
+        const auto value = std::strtoul(env_val, &end, 10);
+
+        if (end == env_val || *end != '\0' || value == 0 || value > std::numeric_limits<unsigned int>::max()) {
+            std::cerr << "ERROR: the worker thread count must be a positive number" << std::endl;
+            std::exit(1);
+        }
+
+        threads = static_cast<unsigned int>(value);
+    }
+
+    other["threads"] = threads != 0 ? threads : 1u;
 }
 
 std::uint32_t
@@ -138,3 +172,13 @@ std::string
 options_t::token_body() const {
     return as_string_at(other, "token_body");
 }
+
+double
+options_t::trace_sample_rate() const {
+    return boost::any_cast<double>(other.at("trace_sample_rate"));
+}
+
+unsigned int
+options_t::threads() const {
+    return boost::any_cast<unsigned int>(other.at("threads"));
+}
@@ -16,6 +16,8 @@
 
 #include "cocaine/framework/worker/receiver.hpp"
 
+#include <boost/assert.hpp>
+
 #include <cocaine/idl/rpc.hpp>
 #include <cocaine/traits/error_code.hpp>
 #include <cocaine/traits/tuple.hpp>
@@ -34,15 +36,25 @@ typedef io::protocol<io::worker::rpc::invoke::upstream_type>::scope protocol;
 
 namespace {
 
+/// Returns the raw payload of the chunk message, which points into the message storage.
+auto payload(const decoded_message& message) -> boost::string_ref {
+    const auto& args = message.args();
+    if (args.type != msgpack::type::ARRAY || args.via.array.size != 1 ||
+        args.via.array.ptr[0].type != msgpack::type::RAW)
+    {
+        throw msgpack::type_error();
+    }
+
+    const auto& raw = args.via.array.ptr[0].via.raw;
+    return boost::string_ref(raw.ptr, raw.size);
+}
+
 auto on_recv(const decoded_message& message) -> boost::optional<std::string> {
     const auto id = message.type();
     switch (id) {
     case io::event_traits<protocol::chunk>::id: {
-        std::string chunk;
-        io::type_traits<
-            io::event_traits<protocol::chunk>::argument_type
-        >::unpack(message.args(), chunk);
-        return chunk;
+        const auto data = payload(message);
+        return std::string(data.data(), data.size());
     }
     case io::event_traits<protocol::error>::id: {
         std::error_code ec;
@@ -61,6 +73,20 @@ auto on_recv(const decoded_message& message) -> boost::optional<std::string> {
     return boost::none;
 }
 
+auto on_recv_chunk(task<decoded_message>::future_move_type future) -> boost::optional<chunk_t> {
+    std::shared_ptr<const decoded_message> message = std::make_shared<decoded_message>(future.get());
+
+    if (message->type() != io::event_traits<protocol::chunk>::id) {
+        // Both error and choke messages carry no payload, so they are handled the usual way, which
+        // either throws or returns none.
+        on_recv(*message);
+        return boost::none;
+    }
+
+    const auto data = payload(*message);
+    return chunk_t(std::move(message), data);
+}
+
 auto on_recv_data(task<decoded_message>::future_move_type future) -> boost::optional<std::string> {
     return on_recv(future.get());
 }
@@ -68,14 +94,7 @@ auto on_recv_data(task<decoded_message>::future_move_type future) -> boost::opti
 auto on_recv_with_meta(future<decoded_message>& future) -> boost::optional<frame_t> {
     const auto message = future.get();
     if (auto chunk = on_recv(message)) {
-        // TODO(@antmat): WTF?
-        hpack::headers_t headers;
-
-        for (const auto& header : message.meta()) {
-            headers.push_back(header);
-        }
-
-        return boost::optional<frame_t>({*chunk, std::move(headers)});
+        return boost::optional<frame_t>({std::move(*chunk), message.meta()});
     }
 
     return boost::none;
@@ -87,9 +106,37 @@ namespace cocaine {
 namespace framework {
 namespace worker {
 
-receiver::receiver(const std::vector<hpack::header_t>& headers,
+chunk_t::chunk_t() {}
+
+chunk_t::chunk_t(std::shared_ptr<const void> owner, boost::string_ref view) :
+    owner(std::move(owner)),
+    view(view)
+{}
+
+chunk_t::chunk_t(std::string data) {
+    auto storage = std::make_shared<const std::string>(std::move(data));
+    view = *storage;
+    owner = std::move(storage);
+}
+
+auto chunk_t::data() const noexcept -> boost::string_ref {
+    return view;
+}
+
+auto chunk_t::slice(boost::string_ref view) const -> chunk_t {
+    BOOST_ASSERT(view.empty() || (view.data() >= this->view.data() &&
+        view.data() + view.size() <= this->view.data() + this->view.size()));
+
+    return chunk_t(owner, view);
+}
+
+auto chunk_t::to_string() const -> std::string {
+    return std::string(view.data(), view.size());
+}
+
+receiver::receiver(std::vector<hpack::header_t> headers,
                    std::shared_ptr<basic_receiver_t<worker_session_t>> session) :
-    headers(headers),
+    headers(std::move(headers)),
     session(std::move(session))
 {}
 
@@ -109,6 +156,12 @@ auto receiver::recv<frame_t>() -> future<boost::optional<frame_t>> {
         .then(std::bind(&on_recv_with_meta, ph::_1));
 }
 
+template<>
+auto receiver::recv<chunk_t>() -> future<boost::optional<chunk_t>> {
+    return session->recv()
+        .then(std::bind(&on_recv_chunk, ph::_1));
+}
+
 }  // namespace worker
 }  // namespace framework
 }  // namespace cocaine
@@ -21,8 +21,11 @@
 #include <cocaine/service/node/error.hpp>
 #include <cocaine/traits/error_code.hpp>
 
+#include "cocaine/framework/encoder.hpp"
 #include "cocaine/framework/sender.hpp"
 
+#include "cocaine/framework/detail/worker/meter.hpp"
+
 namespace ph = std::placeholders;
 
 using namespace cocaine;
@@ -33,9 +36,12 @@ typedef io::protocol<io::worker::rpc::invoke::upstream_type>::scope protocol;
 namespace {
 
 worker::sender
-on_write(task<void>::future_move_type future, std::shared_ptr<basic_sender_t<worker_session_t>> session) {
+on_write(task<void>::future_move_type future,
+         std::shared_ptr<basic_sender_t<worker_session_t>> session,
+         std::shared_ptr<detail::worker::meter_t> meter)
+{
     future.get();
-    return worker::sender(session);
+    return worker::sender(std::move(session), std::move(meter));
 }
 
 void
@@ -54,6 +60,12 @@ worker::sender::sender(std::shared_ptr<basic_sender_t<worker_session_t>> session
     session(std::move(session))
 {}
 
+worker::sender::sender(std::shared_ptr<basic_sender_t<worker_session_t>> session,
+                       std::shared_ptr<detail::worker::meter_t> meter) :
+    session(std::move(session)),
+    meter(std::move(meter))
+{}
+
 worker::sender::~sender() {
     // Close this stream if it wasn't explicitly closed.
     if (session) {
@@ -65,9 +77,70 @@ auto worker::sender::write(std::string message) -> task<worker::sender>::future_
     BOOST_ASSERT(this->session);
 
     auto session = std::move(this->session);
+    auto meter = std::move(this->meter);
+
+    if (meter) {
+        meter->on_write();
+    }
 
     return session->send<protocol::chunk>(std::move(message))
-        .then(std::bind(&on_write, ph::_1, session));
+        .then(std::bind(&on_write, ph::_1, session, meter));
+}
+
+auto worker::sender::write(blob_t blob) -> task<worker::sender>::future_type {
+    BOOST_ASSERT(this->session);
+
+    auto session = std::move(this->session);
+    auto meter = std::move(this->meter);
+
+    if (meter) {
+        meter->on_write();
+    }
+
+    return session->send_raw<protocol::chunk>(std::move(blob))
+        .then(std::bind(&on_write, ph::_1, session, meter));
+}
+
+auto worker::sender::write(const std::vector<boost::string_ref>& messages) -> task<worker::sender>::future_type {
+    BOOST_ASSERT(this->session);
+
+    auto session = std::move(this->session);
+    auto meter = std::move(this->meter);
+
+    if (meter && !messages.empty()) {
+        meter->on_write();
+    }
+
+    encoded_frames_t frames(session->span());
+    for (const auto& message : messages) {
+        frames.append_raw<protocol::chunk>(message);
+    }
+
+    return session->send(std::move(frames))
+        .then(std::bind(&on_write, ph::_1, session, meter));
+}
+
+auto worker::sender::write_and_close(const std::vector<boost::string_ref>& messages) -> task<void>::future_type {
+    BOOST_ASSERT(this->session);
+
+    auto session = std::move(this->session);
+
+    if (meter) {
+        if (!messages.empty()) {
+            meter->on_write();
+        }
+        meter->on_close();
+        meter.reset();
+    }
+
+    encoded_frames_t frames(session->span());
+    for (const auto& message : messages) {
+        frames.append_raw<protocol::chunk>(message);
+    }
+    frames.append<protocol::choke>();
+
+    return session->send(std::move(frames))
+        .then(std::bind(&on_close, ph::_1));
 }
 
 auto worker::sender::error(int ec, std::string reason) -> task<void>::future_type {
@@ -79,6 +152,11 @@ auto worker::sender::error(std::error_code ec, std::string reason) -> task<void>
 
     auto session = std::move(this->session);
 
+    if (meter) {
+        meter->on_error();
+        meter.reset();
+    }
+
     return session->send<protocol::error>(ec, std::move(reason))
         .then(std::bind(&on_error, ph::_1));
 }
@@ -88,6 +166,11 @@ auto worker::sender::close() -> task<void>::future_type {
 
     auto session = std::move(this->session);
 
+    if (meter) {
+        meter->on_close();
+        meter.reset();
+    }
+
     return session->send<protocol::choke>()
         .then(std::bind(&on_close, ph::_1));
 }
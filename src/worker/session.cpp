@@ -16,6 +16,8 @@
 
 #include "cocaine/framework/detail/worker/session.hpp"
 
+#include <chrono>
+
 #include <cocaine/hpack/static_table.hpp>
 #include <cocaine/traits/enum.hpp>
 #include <cocaine/idl/streaming.hpp>
@@ -25,6 +27,7 @@
 #include "cocaine/framework/worker/error.hpp"
 #include "cocaine/framework/worker/receiver.hpp"
 
+#include "cocaine/framework/detail/channel.hpp"
 #include "cocaine/framework/detail/log.hpp"
 #include "cocaine/framework/detail/loop.hpp"
 #include "cocaine/framework/detail/shared_state.hpp"
@@ -44,20 +47,26 @@ const boost::posix_time::time_duration DISOWN_TIMEOUT = boost::posix_time::secon
 template<class Session>
 class worker_session_t::push_t : public std::enable_shared_from_this<push_t<Session>> {
     io::encoder_t::message_type message;
+    blob_t blob;
+    std::size_t size;
     std::shared_ptr<Session> session;
     task<void>::promise_type h;
+    std::chrono::steady_clock::time_point start;
 
 public:
-    explicit push_t(io::encoder_t::message_type _message, std::shared_ptr<Session> session, task<void>::promise_type&& h) :
+    explicit push_t(io::encoder_t::message_type _message, blob_t _blob, std::shared_ptr<Session> session, task<void>::promise_type&& h) :
         message(std::move(_message)),
+        blob(std::move(_blob)),
+        size(message.size() + blob.size()),
         session(session),
-        h(std::move(h))
+        h(std::move(h)),
+        start(std::chrono::steady_clock::now())
     {}
 
     void operator()() {
-        auto transport = session->transport.synchronize();
-        if (*transport) {
-            (*transport)->writer->write(message, std::bind(&push_t::on_write, this->shared_from_this(), ph::_1));
+        auto writer = *session->writer.synchronize();
+        if (writer) {
+            writer->write(std::move(message), std::move(blob), std::bind(&push_t::on_write, this->shared_from_this(), ph::_1));
         } else {
             h.set_exception(std::system_error(asio::error::not_connected));
         }
@@ -71,26 +80,57 @@ private:
             session->on_error(ec);
             h.set_exception(std::system_error(ec));
         } else {
+            session->metrics.frames_written.inc();
+            session->metrics.bytes_written.inc(size);
+            session->metrics.write_latency.record_since(start);
             h.set_value();
         }
     }
 };
 
-worker_session_t::worker_session_t(dispatch_t& dispatch, scheduler_t& scheduler, executor_t executor) :
+worker_session_t::metrics_t::metrics_t(detail::metrics::registry_t& registry) :
+    channels(registry.gauge("worker.channels")),
+    invokes(registry.counter("worker.invokes")),
+    frames_read(registry.counter("worker.frames.read")),
+    bytes_read(registry.counter("worker.bytes.read")),
+    frames_written(registry.counter("worker.frames.written")),
+    bytes_written(registry.counter("worker.bytes.written")),
+    write_latency(registry.histogram("worker.write.latency")),
+    registry(registry),
+    fallback(registry, "worker.fallback")
+{}
+
+auto worker_session_t::metrics_t::event(const std::string& name) -> detail::worker::event_metrics_t& {
+    auto& metrics = events[name];
+    if (!metrics) {
+        metrics.reset(new detail::worker::event_metrics_t(registry, "worker.events." + name));
+    }
+
+    return *metrics;
+}
+
+worker_session_t::worker_session_t(dispatch_t& dispatch, scheduler_t& scheduler, executor_t executor,
+                                   trace::sampler_t sampler) :
     dispatch(dispatch),
     scheduler(scheduler),
     executor(std::move(executor)),
+    sampler(sampler),
     message(boost::none),
     counter(0),
+    slab(std::make_shared<detail::slab_t>()),
+    receivers(std::make_shared<detail::slab_t>()),
     heartbeat_timer(scheduler.loop().loop),
-    disown_timer(scheduler.loop().loop)
+    disown_timer(scheduler.loop().loop),
+    metrics(scheduler.loop().metrics)
 {}
 void
 worker_session_t::connect(const endpoint_type& endpoint) {
     std::unique_ptr<protocol_type::socket> socket(new protocol_type::socket(scheduler.loop().loop));
     socket->connect(endpoint);
 
+    auto transport = this->transport.synchronize();
     transport->reset(new transport_type(std::move(socket)));
+    *writer.synchronize() = std::make_shared<writer_type>((*transport)->socket);
 }
 
 void
@@ -104,6 +144,11 @@ worker_session_t::run(const std::string& uuid) {
 
 future<void>
 worker_session_t::push(io::encoder_t::message_type&& message) {
+    return push(std::move(message), blob_t());
+}
+
+future<void>
+worker_session_t::push(io::encoder_t::message_type&& message, blob_t blob) {
     promise<void> pr;
     auto fr = pr.get_future();
 
@@ -111,7 +156,7 @@ worker_session_t::push(io::encoder_t::message_type&& message) {
         std::bind(
             &push_t<worker_session_t>::operator(),
             std::make_shared<push_t<worker_session_t>>(
-                std::move(message), shared_from_this(), std::move(pr)
+                std::move(message), std::move(blob), shared_from_this(), std::move(pr)
             )
         )
     );
@@ -124,7 +169,9 @@ worker_session_t::revoke(std::uint64_t span) {
     CF_DBG("revoking span %llu channel", CF_US(span));
 
     scheduler.loop().loop.post([=]() {
-        channels->erase(span);
+        if (channels->erase(span) > 0) {
+            metrics.channels.dec();
+        }
     });
 }
 
@@ -188,6 +235,9 @@ void worker_session_t::on_read(const std::error_code& ec) {
         return;
     }
 
+    metrics.frames_read.inc();
+    metrics.bytes_read.inc(message.size());
+
     process();
 
     CF_DBG("waiting for more data ...");
@@ -199,9 +249,12 @@ void worker_session_t::on_error(const std::error_code& ec) {
     BOOST_ASSERT(ec);
 
     auto channels = this->channels.synchronize();
-    for (auto channel : *channels) {
-        channel.second->put(ec);
+    for (const auto& channel : *channels) {
+        if (auto state = channel.second.lock()) {
+            state->put(ec);
+        }
     }
+    metrics.channels.dec(static_cast<std::int64_t>(channels->size()));
     channels->clear();
 
     throw error_t(ec, "I/O error");
@@ -241,9 +294,9 @@ worker_session_t::process_control(std::uint64_t id) {
 
 void
 worker_session_t::process_rpc(std::uint64_t id, std::uint64_t span) {
-    std::map<std::uint64_t, std::shared_ptr<shared_state_t>>::const_iterator lb, ub;
+    std::map<std::uint64_t, std::weak_ptr<shared_state_t>>::const_iterator lb, ub;
 
-    channels.apply([&](std::map<std::uint64_t, std::shared_ptr<shared_state_t>>& channels) {
+    channels.apply([&](std::map<std::uint64_t, std::weak_ptr<shared_state_t>>& channels) {
         std::tie(lb, ub) = channels.equal_range(span);
 
         if (lb == ub) {
@@ -260,17 +313,27 @@ worker_session_t::process_rpc(std::uint64_t id, std::uint64_t span) {
         } else {
             typedef io::protocol<io::worker::rpc::invoke::upstream_type>::scope protocol;
 
+            // Both channel ends may already be released, but the channel is still expected to be
+            // closed properly.
+            const auto put = [&](const std::weak_ptr<shared_state_t>& channel) {
+                if (auto state = channel.lock()) {
+                    state->put(std::move(message));
+                }
+            };
+
             switch (id) {
             case (io::event_traits<protocol::chunk>::id):
-                lb->second->put(std::move(message));
+                put(lb->second);
                 break;
             case (io::event_traits<protocol::error>::id):
-                lb->second->put(std::move(message));
+                put(lb->second);
                 channels.erase(lb);
+                metrics.channels.dec();
                 break;
             case (io::event_traits<protocol::choke>::id):
-                lb->second->put(std::move(message));
+                put(lb->second);
                 channels.erase(lb);
+                metrics.channels.dec();
                 break;
             default:
                 throw invalid_protocol_type(id);
@@ -291,51 +354,51 @@ void worker_session_t::process_terminate() {
     terminate(0, "confirmed");
 }
 
-void worker_session_t::process_invoke(std::map<std::uint64_t, std::shared_ptr<shared_state_t>>& channels) {
+void worker_session_t::process_invoke(std::map<std::uint64_t, std::weak_ptr<shared_state_t>>& channels) {
     std::string event;
     io::type_traits<
         io::event_traits<io::worker::rpc::invoke>::argument_type
     >::unpack(message.args(), event);
     CF_DBG("-> Invoke '%s'", event.c_str());
 
+    const auto handler = dispatch.get(event);
+
+    // The meter lives in the channel block, so metering costs no allocation.
     auto id = message.span();
-    auto tx = std::make_shared<basic_sender_t<worker_session_t>>(id, shared_from_this());
-    auto state = std::make_shared<shared_state_t>();
-    auto rx = worker::receiver(
-        message.meta(),
-        std::make_shared<basic_receiver_t<worker_session_t>>(id, shared_from_this(), state)
+    auto channel = detail::make_channel<worker_session_t, detail::worker::meter_t>(
+        id, shared_from_this(), slab, receivers, handler ? metrics.event(event) : metrics.fallback
     );
+    auto tx = std::move(channel.tx);
+    auto rx = worker::receiver(message.take_meta(), std::move(channel.rx));
+    auto meter = std::move(channel.payload);
 
-    auto trace_id = message.get_header<hpack::headers::trace_id<>>();
-    auto span_id = message.get_header<hpack::headers::span_id<>>();
-    auto parent_id = message.get_header<hpack::headers::parent_id<>>();
-
+    // Tracing headers are extracted from the message lazily, on its first trace() call. Unsampled
+    // requests are handled as if there were no trace at all, so no trace is captured further.
     boost::optional<trace_t> trace;
-    if(trace_id && span_id && parent_id &&
-            !trace_id->value().empty() && !span_id->value().empty() && ! parent_id->value().empty()) {
-        try {
-            trace = trace_t(
-                    hpack::header::unpack<uint64_t>(message.get_header<hpack::headers::trace_id<>>()->value()),
-                    hpack::header::unpack<uint64_t>(message.get_header<hpack::headers::span_id<>>()->value()),
-                    hpack::header::unpack<uint64_t>(message.get_header<hpack::headers::parent_id<>>()->value()),
-                    event);
-        } catch (const std::exception& e) {
-            CF_DBG("could not decode tracing headers - %s", e.what());
+    if (const auto& headers = message.trace()) {
+        if (sampler.sampled(headers->trace_id)) {
+            trace = trace_t(headers->trace_id, headers->span_id, headers->parent_id, event);
         }
     }
 
+    metrics.invokes.inc();
+
     trace_t::restore_scope_t scope(trace);
-    if (auto handler = dispatch.get(event)) {
-        channels.insert(std::make_pair(id, state));
-        executor([handler, tx, rx](){
-            (*handler)(tx, rx);
+    if (handler) {
+        channels.insert(std::make_pair(id, std::weak_ptr<shared_state_t>(channel.state)));
+        metrics.channels.inc();
+        executor([handler, tx, rx, meter](){
+            meter->on_start();
+            (*handler)(worker::sender(tx, meter), rx);
         });
     } else {
         CF_DBG("event '%s' not found, invoking fallback handler", event.c_str());
+
         const auto fallback = dispatch.fallback();
 
         executor([=]() {
-            fallback(event, tx, rx);
+            meter->on_start();
+            fallback(event, worker::sender(tx, meter), rx);
         });
     }
 }
@@ -0,0 +1,394 @@
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <cocaine/idl/node.hpp>
+#include <cocaine/idl/storage.hpp>
+#include <cocaine/idl/streaming.hpp>
+
+#include <cocaine/common.hpp>
+#include <cocaine/trace/trace.hpp>
+#include <cocaine/traits/error_code.hpp>
+
+#include <cocaine/framework/manager.hpp>
+#include <cocaine/framework/service.hpp>
+#include <cocaine/framework/trace.hpp>
+
+#include <cocaine/framework/detail/metrics.hpp>
+
+#include "../util/allocation.hpp"
+#include "../util/env.hpp"
+#include "../util/stub.hpp"
+
+using namespace cocaine;
+using namespace cocaine::framework;
+
+using namespace testing;
+using namespace testing::util;
+
+/// Self-contained benchmark suite, running the framework client against an in-process stub of the
+/// cocaine runtime, so no real runtime or configuration is required.
+///
+/// Each benchmark emits a single JSON object per line to stdout. Parameters are taken from the
+/// environment:
+///  - BENCH_ITERS     - number of RPCs per benchmark (10000).
+///  - BENCH_THREADS   - number of service manager threads (1).
+///  - BENCH_CHUNKS    - number of chunks in the streaming benchmark (10000).
+///  - BENCH_CHUNK_SIZE - chunk size in bytes for the streaming benchmark (1024).
+namespace testing { namespace bench {
+
+typedef std::chrono::steady_clock clock_type;
+typedef io::protocol<io::app::enqueue::dispatch_type>::scope upstream;
+
+typedef detail::metrics::histogram_t histogram_t;
+
+const std::string PAYLOAD = "le message";
+
+double
+seconds_since(clock_type::time_point start) {
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+/// Prints the latency distribution in microseconds together with the given fields as a JSON line.
+void
+emit(const std::string& name, const std::string& fields, const histogram_t& histogram) {
+    const auto snapshot = histogram.snapshot();
+
+    std::printf(
+        "{\"bench\":\"%s\",%s,\"count\":%llu,\"mean_us\":%.3f,"
+        "\"p50_us\":%llu,\"p90_us\":%llu,\"p99_us\":%llu,\"p999_us\":%llu,\"max_us\":%llu}\n",
+        name.c_str(),
+        fields.c_str(),
+        static_cast<unsigned long long>(snapshot.count),
+        snapshot.mean(),
+        static_cast<unsigned long long>(snapshot.quantile(0.5)),
+        static_cast<unsigned long long>(snapshot.quantile(0.9)),
+        static_cast<unsigned long long>(snapshot.quantile(0.99)),
+        static_cast<unsigned long long>(snapshot.quantile(0.999)),
+        static_cast<unsigned long long>(snapshot.max())
+    );
+    std::fflush(stdout);
+}
+
+/// Performs a single streaming RPC, sending one chunk and receiving it back.
+void
+echo(service<io::app_tag>& service) {
+    auto channel = service.invoke<io::app::enqueue>(std::string("ping")).get();
+    channel.tx.send<upstream::chunk>(PAYLOAD).get()
+        .send<upstream::choke>().get();
+
+    const auto chunk = channel.rx.recv().get();
+    if (!chunk || *chunk != PAYLOAD) {
+        throw std::runtime_error("echo payload mismatch");
+    }
+
+    // Read the choke.
+    channel.rx.recv().get();
+}
+
+/// Performs a single unary RPC.
+void
+read(service<io::storage_tag>& service) {
+    const auto value = service.invoke<io::storage::read>(std::string("collection"), std::string("key")).get();
+    if (value.size() != runtime_t::VALUE.size()) {
+        throw std::runtime_error("storage value mismatch");
+    }
+}
+
+/// Measures RPC latency and throughput, performing the given number of RPCs using the given number
+/// of concurrent clients.
+template<class Service, class F>
+void
+throughput(const std::string& name, Service& service, F rpc, std::uint64_t iters, unsigned int concurrency) {
+    histogram_t histogram;
+
+    const auto start = clock_type::now();
+
+    // Exceptions can not leave a thread, so they are passed to the main one and rethrown there.
+    std::vector<std::exception_ptr> errors(concurrency);
+
+    std::vector<std::thread> clients;
+    for (unsigned int id = 0; id < concurrency; ++id) {
+        clients.emplace_back([&, id] {
+            try {
+                for (std::uint64_t i = 0; i < iters / concurrency; ++i) {
+                    const auto birth = clock_type::now();
+                    rpc(service);
+                    histogram.record_since(birth);
+                }
+            } catch (...) {
+                errors[id] = std::current_exception();
+            }
+        });
+    }
+
+    for (auto& client : clients) {
+        client.join();
+    }
+
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    const auto elapsed = seconds_since(start);
+    const auto count = histogram.snapshot().count;
+
+    char fields[128];
+    std::snprintf(fields, sizeof(fields), "\"concurrency\":%u,\"rps\":%.1f",
+        concurrency, static_cast<double>(count) / elapsed);
+
+    emit(name, fields, histogram);
+}
+
+/// Measures the latency of opening a channel with an already connected service, excluding the
+/// round trip of the request itself.
+void
+invoke(const std::string& name, service<io::app_tag>& service, std::uint64_t iters) {
+    histogram_t histogram;
+
+    for (std::uint64_t i = 0; i < iters; ++i) {
+        const auto birth = clock_type::now();
+        auto channel = service.invoke<io::app::enqueue>(std::string("ping")).get();
+        histogram.record_since(birth);
+
+        channel.tx.send<upstream::choke>().get();
+        channel.rx.recv().get();
+    }
+
+    emit(name, "\"connected\":true", histogram);
+}
+
+/// Measures the per-RPC tracing overhead, performing RPCs within traces sampled with the given rate
+/// the same way the worker samples incoming requests.
+///
+/// Sampled RPCs carry trace headers, capture the trace in every continuation and emit trace log
+/// records, while unsampled ones run without a trace at all.
+template<class Service, class F>
+void
+tracing(const std::string& name, Service& service, F rpc, std::uint64_t iters, double rate) {
+    const framework::trace::sampler_t sampler(rate);
+
+    histogram_t histogram;
+
+    const auto start = clock_type::now();
+    for (std::uint64_t id = 1; id <= iters; ++id) {
+        boost::optional<trace_t> trace;
+        if (sampler.sampled(id)) {
+            trace = trace_t(id, id, 0, "bench");
+        }
+
+        const auto birth = clock_type::now();
+        {
+            trace_t::restore_scope_t scope(trace);
+            rpc(service);
+        }
+        histogram.record_since(birth);
+    }
+
+    const auto elapsed = seconds_since(start);
+
+    char fields[128];
+    std::snprintf(fields, sizeof(fields), "\"sample_rate\":%.2f,\"rps\":%.1f",
+        rate, static_cast<double>(iters) / elapsed);
+
+    emit(name, fields, histogram);
+}
+
+/// Measures the number of dynamic allocations per RPC made by the framework and the caller.
+///
+/// Allocations made by the stub runtime are excluded.
+template<class Service, class F>
+void
+allocations(const std::string& name, Service& service, F rpc, std::uint64_t iters) {
+    // Warm up all lazily initialized stuff, like thread-local buffers.
+    for (int i = 0; i < 100; ++i) {
+        rpc(service);
+    }
+
+    histogram_t histogram;
+
+    const auto before = allocation::count();
+    for (std::uint64_t i = 0; i < iters; ++i) {
+        const auto birth = clock_type::now();
+        rpc(service);
+        histogram.record_since(birth);
+    }
+    const auto after = allocation::count();
+
+    char fields[128];
+    std::snprintf(fields, sizeof(fields), "\"allocations_per_rpc\":%.2f",
+        static_cast<double>(after - before) / static_cast<double>(iters));
+
+    emit(name, fields, histogram);
+}
+
+/// Reads the given number of keys by invoking the storage once per key.
+void
+read_loop(service<io::storage_tag>& service, std::size_t keys) {
+    std::vector<task<std::string>::future_type> futures;
+    futures.reserve(keys);
+    for (std::size_t id = 0; id < keys; ++id) {
+        futures.push_back(service.invoke<io::storage::read>(std::string("collection"), std::to_string(id)));
+    }
+
+    for (auto& future : futures) {
+        future.get();
+    }
+}
+
+/// Reads the given number of keys using a single batched invocation.
+void
+read_many(service<io::storage_tag>& service, std::size_t keys) {
+    std::vector<std::tuple<std::string, std::string>> args;
+    args.reserve(keys);
+    for (std::size_t id = 0; id < keys; ++id) {
+        args.emplace_back("collection", std::to_string(id));
+    }
+
+    for (auto& future : service.invoke_many<io::storage::read>(std::move(args))) {
+        future.get();
+    }
+}
+
+/// Measures fan-out throughput, reading the given number of keys per iteration.
+template<class F>
+void
+fanout(const std::string& name, service<io::storage_tag>& service, F rpc, std::uint64_t iters, std::size_t keys) {
+    histogram_t histogram;
+
+    const auto start = clock_type::now();
+    for (std::uint64_t i = 0; i < iters / keys; ++i) {
+        const auto birth = clock_type::now();
+        rpc(service, keys);
+        histogram.record_since(birth);
+    }
+
+    const auto elapsed = seconds_since(start);
+
+    char fields[128];
+    std::snprintf(fields, sizeof(fields), "\"keys\":%zu,\"keys_per_sec\":%.1f",
+        keys, static_cast<double>(histogram.snapshot().count * keys) / elapsed);
+
+    // The histogram holds the latency of the whole fan-out.
+    emit(name, fields, histogram);
+}
+
+/// Measures streaming throughput by sending the given number of chunks through a single channel
+/// and receiving all of them back.
+void
+streaming(service<io::app_tag>& service, std::uint64_t chunks, std::size_t size) {
+    const std::string chunk(size, 'x');
+
+    histogram_t histogram;
+
+    const auto start = clock_type::now();
+
+    auto channel = service.invoke<io::app::enqueue>(std::string("stream")).get();
+
+    // Exceptions can not leave a thread, so the reader passes its one to the writer, which rethrows
+    // it after joining.
+    std::exception_ptr failure;
+
+    std::thread reader([&] {
+        try {
+            for (std::uint64_t id = 0; id < chunks; ++id) {
+                const auto birth = clock_type::now();
+                if (!channel.rx.recv().get()) {
+                    throw std::runtime_error("unexpected end of stream");
+                }
+                histogram.record_since(birth);
+            }
+
+            // Read the choke.
+            channel.rx.recv().get();
+        } catch (...) {
+            failure = std::current_exception();
+        }
+    });
+
+    // The reader must be joined even if writing fails, otherwise its destructor terminates.
+    std::exception_ptr error;
+    try {
+        auto tx = std::move(channel.tx);
+        for (std::uint64_t id = 0; id < chunks; ++id) {
+            tx = tx.send<upstream::chunk>(chunk).get();
+        }
+        tx.send<upstream::choke>().get();
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    reader.join();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+
+    const auto elapsed = seconds_since(start);
+
+    char fields[128];
+    std::snprintf(fields, sizeof(fields), "\"chunk_size\":%zu,\"chunks_per_sec\":%.1f,\"mb_per_sec\":%.2f",
+        size,
+        static_cast<double>(chunks) / elapsed,
+        static_cast<double>(chunks * size) / elapsed / (1024 * 1024));
+
+    // The histogram holds the interval between consecutive chunks received.
+    emit("echo.streaming", fields, histogram);
+}
+
+}} // namespace testing::bench
+
+int main(int, char**) {
+    const auto iters = get_option<std::uint64_t>("BENCH_ITERS", 10000);
+    const auto threads = get_option<unsigned int>("BENCH_THREADS", 1);
+    const auto chunks = get_option<std::uint64_t>("BENCH_CHUNKS", 10000);
+    const auto size = get_option<std::size_t>("BENCH_CHUNK_SIZE", 1024);
+
+    util::runtime_t runtime;
+
+    const auto locator = runtime.endpoint();
+    const std::vector<service_manager_t::endpoint_type> endpoints = {
+        { boost::asio::ip::address::from_string(locator.address().to_string()), locator.port() }
+    };
+
+    service_manager_t manager(endpoints, threads);
+
+    auto echo = manager.create<io::app_tag>("echo");
+    auto storage = manager.create<io::storage_tag>("storage");
+    echo.connect().get();
+    storage.connect().get();
+
+    for (unsigned int concurrency : { 1, 4, 16, 64 }) {
+        bench::throughput("echo.rpc", echo, &bench::echo, iters, concurrency);
+        bench::throughput("storage.read", storage, &bench::read, iters, concurrency);
+    }
+
+    bench::invoke("echo.invoke", echo, iters);
+
+    for (double rate : { 0.0, 0.01, 1.0 }) {
+        bench::tracing("echo.tracing", echo, &bench::echo, iters, rate);
+    }
+
+    for (std::size_t keys : { 8, 32, 128 }) {
+        bench::fanout("storage.read.loop", storage, &bench::read_loop, iters, keys);
+        bench::fanout("storage.read.many", storage, &bench::read_many, iters, keys);
+    }
+
+    bench::streaming(echo, chunks, size);
+
+    bench::allocations("echo.allocations", echo, &bench::echo, iters);
+    bench::allocations("storage.allocations", storage, &bench::read, iters);
+
+    return 0;
+}
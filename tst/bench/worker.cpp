@@ -0,0 +1,338 @@
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <asio/io_service.hpp>
+#include <asio/local/stream_protocol.hpp>
+
+#include <msgpack.hpp>
+
+#include <cocaine/idl/rpc.hpp>
+#include <cocaine/idl/streaming.hpp>
+
+#include <cocaine/common.hpp>
+
+#include <cocaine/framework/encoder.hpp>
+#include <cocaine/framework/worker.hpp>
+#include <cocaine/framework/worker/http.hpp>
+
+#include <cocaine/framework/detail/metrics.hpp>
+
+#include "../util/env.hpp"
+#include "../util/stub.hpp"
+
+using namespace cocaine;
+using namespace cocaine::framework;
+
+using namespace testing;
+using namespace testing::util;
+
+/// Worker-side benchmark, driving worker_t through a fake runtime listening on a unix socket.
+///
+/// The fake runtime answers the handshake and heartbeats and fires invoke-chunk-choke sequences at
+/// the worker, keeping a fixed number of them in flight. Each run emits a single JSON object per
+/// line to stdout. Parameters are taken from the environment:
+///  - BENCH_ITERS    - number of invocations per run (100000).
+///  - BENCH_INFLIGHT - number of invocations in flight (128).
+///  - BENCH_SOCKET   - unix socket path (/tmp/cocaine-framework-bench.sock).
+///
+/// Each event is benchmarked with 1, 2, 4 and 8 executor threads.
+namespace testing { namespace bench {
+
+typedef std::chrono::steady_clock clock_type;
+
+typedef io::protocol<io::worker::rpc::invoke::dispatch_type>::scope incoming;
+typedef io::protocol<io::worker::rpc::invoke::upstream_type>::scope outgoing;
+
+typedef detail::metrics::histogram_t histogram_t;
+
+/// Channel id, reserved for control messages.
+const std::uint64_t CONTROL = 1;
+
+/// Returns the CPU time (user and system) consumed by either the process or the calling thread.
+std::chrono::microseconds
+cpu(int who) {
+    ::rusage usage;
+    ::getrusage(who, &usage);
+
+    return std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+        std::chrono::microseconds(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+/// Fires the given number of invocations of the event with the given payload at the worker,
+/// keeping at most the given number of them in flight.
+void
+run(worker_runtime_t& runtime, const std::string& name, const std::string& event, const std::string& payload,
+    std::uint64_t iters, std::uint64_t inflight, std::uint64_t& span, unsigned int threads)
+{
+    histogram_t histogram;
+
+    const auto base = span;
+    std::unique_ptr<std::atomic<clock_type::rep>[]> births(new std::atomic<clock_type::rep>[iters]);
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::uint64_t pending = 0;
+    std::uint64_t errors = 0;
+    bool stopped = false;
+
+    // Exceptions can not leave a thread, so the writer passes its one to the reader, which
+    // rethrows it after joining.
+    std::exception_ptr failure;
+    std::atomic<bool> failed(false);
+
+    const auto cpu_before = cpu(RUSAGE_SELF);
+    const auto start = clock_type::now();
+
+    std::chrono::microseconds cpu_writer(0);
+    std::thread writer([&] {
+        const auto cpu_start = cpu(RUSAGE_THREAD);
+
+        try {
+            for (std::uint64_t id = 0; id < iters; ++id) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait(lock, [&] { return stopped || pending < inflight; });
+                    if (stopped) {
+                        break;
+                    }
+                    ++pending;
+                }
+
+                births[id].store(clock_type::now().time_since_epoch().count(), std::memory_order_release);
+
+                encoded_frames_t frames(base + id);
+                frames.append<io::worker::rpc::invoke>(event);
+                frames.append_raw<incoming::chunk>(payload);
+                frames.append<incoming::choke>();
+                runtime.write(frames.data(), frames.size());
+            }
+        } catch (...) {
+            failure = std::current_exception();
+            failed = true;
+        }
+
+        cpu_writer = cpu(RUSAGE_THREAD) - cpu_start;
+    });
+
+    const auto cpu_reader_start = cpu(RUSAGE_THREAD);
+
+    // The writer must be stopped and joined even if reading fails, otherwise its destructor
+    // terminates.
+    std::exception_ptr error;
+    try {
+        msgpack::unpacked result;
+        for (std::uint64_t completed = 0; completed < iters && !failed;) {
+            if (!runtime.read(result)) {
+                throw std::runtime_error("unexpected EOF from the worker");
+            }
+
+            const auto& frame = result.get().via.array;
+            const auto channel = frame.ptr[0].as<std::uint64_t>();
+            const auto type = frame.ptr[1].as<std::uint64_t>();
+
+            if (channel == CONTROL) {
+                if (type == io::event_traits<io::worker::heartbeat>::id) {
+                    runtime.send<io::worker::heartbeat>(CONTROL);
+                }
+                continue;
+            }
+
+            if (type == io::event_traits<outgoing::chunk>::id) {
+                continue;
+            }
+
+            const auto birth = clock_type::time_point(clock_type::duration(
+                births[channel - base].load(std::memory_order_acquire)
+            ));
+            histogram.record_since(birth);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --pending;
+                if (type == io::event_traits<outgoing::error>::id) {
+                    ++errors;
+                }
+            }
+            cv.notify_one();
+
+            ++completed;
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    const auto cpu_reader = cpu(RUSAGE_THREAD) - cpu_reader_start;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+    }
+    cv.notify_all();
+
+    writer.join();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+
+    const auto elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+
+    // Exclude the fake runtime, leaving only CPU consumed by the worker itself.
+    const auto cpu_worker = cpu(RUSAGE_SELF) - cpu_before - cpu_reader - cpu_writer;
+
+    span += iters;
+
+    const auto snapshot = histogram.snapshot();
+    std::printf(
+        "{\"bench\":\"%s\",\"threads\":%u,\"inflight\":%llu,\"count\":%llu,\"errors\":%llu,"
+        "\"rps\":%.1f,\"cpu_us_per_request\":%.3f,\"mean_us\":%.3f,"
+        "\"p50_us\":%llu,\"p99_us\":%llu,\"p999_us\":%llu,\"max_us\":%llu}\n",
+        name.c_str(),
+        threads,
+        static_cast<unsigned long long>(inflight),
+        static_cast<unsigned long long>(snapshot.count),
+        static_cast<unsigned long long>(errors),
+        static_cast<double>(iters) / elapsed,
+        static_cast<double>(cpu_worker.count()) / static_cast<double>(iters),
+        snapshot.mean(),
+        static_cast<unsigned long long>(snapshot.quantile(0.5)),
+        static_cast<unsigned long long>(snapshot.quantile(0.99)),
+        static_cast<unsigned long long>(snapshot.quantile(0.999)),
+        static_cast<unsigned long long>(snapshot.max())
+    );
+    std::fflush(stdout);
+}
+
+void
+on_echo(worker::sender tx, worker::receiver rx) {
+    const auto chunk = rx.recv().get();
+    if (chunk) {
+        tx.write_and_close(std::vector<boost::string_ref>{ *chunk }).get();
+    } else {
+        tx.close().get();
+    }
+}
+
+void
+on_http(worker::http::event<>::fresh_sender tx, worker::http::event<>::fresh_receiver rx) {
+    static const worker::encoded_http_response_t response(worker::http_response_t{
+        200, {{ "Content-Type", "text/plain" }}
+    });
+
+    rx.recv().get();
+    tx.send_and_close(response, "OK").get();
+}
+
+std::string
+http_request() {
+    msgpack::sbuffer buffer;
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+
+    const worker::http_request_t request = { "GET", "/", "1.1", {{ "Host", "localhost" }} };
+    io::type_traits<worker::http_request_t>::pack(packer, request, std::string());
+
+    return std::string(buffer.data(), buffer.size());
+}
+
+}} // namespace testing::bench
+
+int main(int, char**) {
+    const auto iters = get_option<std::uint64_t>("BENCH_ITERS", 100000);
+    const auto inflight = get_option<std::uint64_t>("BENCH_INFLIGHT", 128);
+    const auto path = get_option<std::string>("BENCH_SOCKET", "/tmp/cocaine-framework-bench.sock");
+
+    ::unlink(path.c_str());
+
+    asio::io_service io;
+    asio::local::stream_protocol::acceptor acceptor(io, asio::local::stream_protocol::endpoint(path));
+
+    for (unsigned int threads : { 1, 2, 4, 8 }) {
+        const auto value = std::to_string(threads);
+        ::setenv("COCAINE_FRAMEWORK_WORKER_THREADS", value.c_str(), 1);
+
+        std::vector<std::string> args = {
+            "bench-worker",
+            "--app", "bench",
+            "--uuid", "00000000-0000-0000-0000-000000000000",
+            "--endpoint", path,
+            "--locator", "127.0.0.1:10053"
+        };
+
+        std::vector<char*> argv;
+        for (auto& arg : args) {
+            argv.push_back(&arg[0]);
+        }
+
+        worker_t app(options_t(static_cast<int>(argv.size()), argv.data()));
+        app.on("echo", &bench::on_echo);
+        app.on<worker::http::event<>>("http", &bench::on_http);
+
+        std::thread thread([&app] {
+            app.run();
+        });
+
+        asio::local::stream_protocol::socket socket(io);
+        acceptor.accept(socket);
+
+        // The worker stops after the fake runtime closes its socket, so on failure it is closed
+        // before joining the worker thread, otherwise its destructor terminates.
+        std::exception_ptr error;
+        {
+            util::worker_runtime_t runtime(::dup(socket.native_handle()));
+            socket.close();
+
+            try {
+                // Wait for the handshake.
+                msgpack::unpacked result;
+                if (!runtime.read(result)) {
+                    throw std::runtime_error("unexpected EOF from the worker");
+                }
+
+                std::uint64_t span = 2;
+                bench::run(runtime, "worker.echo", "echo", "le message", iters, inflight, span, threads);
+                bench::run(runtime, "worker.http", "http", bench::http_request(), iters, inflight, span, threads);
+
+                runtime.send<io::worker::terminate>(bench::CONTROL, 0, std::string("benchmark is over"));
+
+                // Drain everything until the worker confirms the termination.
+                while (runtime.read(result)) {
+                    const auto& frame = result.get().via.array;
+                    if (frame.ptr[0].as<std::uint64_t>() == bench::CONTROL &&
+                        frame.ptr[1].as<std::uint64_t>() == io::event_traits<io::worker::terminate>::id)
+                    {
+                        break;
+                    }
+                }
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+
+        thread.join();
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    ::unlink(path.c_str());
+
+    return 0;
+}
@@ -43,7 +43,8 @@ TEST(service_manager, MoreMultipleLocations) {
 }
 
 TEST(service_manager, ThrowsOnInvalidFqdn) {
-    EXPECT_THROW(service_manager_t manager({std::make_tuple("wtf", 10053)}, 1), std::exception);
+    service_manager_t manager({std::make_tuple("wtf", 10053)}, 1);
+    EXPECT_THROW(manager.endpoints(), std::exception);
 }
 
 TEST(service, NotFound) {
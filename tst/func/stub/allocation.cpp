@@ -0,0 +1,37 @@
+#include <gtest/gtest.h>
+
+#include <cocaine/framework/forwards.hpp>
+
+#include "../../util/allocation.hpp"
+
+using namespace cocaine;
+using namespace cocaine::framework;
+
+using namespace testing;
+using namespace testing::util;
+
+/// Allocation budgets, which stop allocation regressions from being merged unnoticed.
+///
+/// Each budget covers allocations made by the caller and all framework threads during a single
+/// operation, as counted by the `operator new` replacement from tst/util/operator_new.cpp. Every
+/// test records the counted number as its "allocations" property, so a budget is taken from the
+/// `--gtest_output=xml` report of the allocation tests built in release mode. Lower them after
+/// removing allocations from the corresponding path.
+///
+/// READY_FUTURE_THEN is measured that way with GCC 12.2 at both -O0 and -O2: a ready future keeps
+/// its value inline and `then` invokes the callback at once, so nothing is allocated.
+namespace testing { namespace budget {
+
+const std::uint64_t READY_FUTURE_THEN = 0;
+
+}} // namespace testing::budget
+
+TEST(allocation, ReadyFutureThen) {
+    EXPECT_ALLOCATIONS_LE(budget::READY_FUTURE_THEN,
+        make_ready_future<int>::value(42)
+            .then([](task<int>::future_move_type future) {
+                return future.get() + 1;
+            })
+            .get()
+    );
+}
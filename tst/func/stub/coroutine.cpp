@@ -0,0 +1,104 @@
+#include <stdexcept>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <cocaine/framework/coroutine.hpp>
+
+#if !COCAINE_FRAMEWORK_HAS_COROUTINES
+#   error "coroutine tests must be built with C++20 coroutines enabled"
+#endif
+
+using namespace cocaine::framework;
+
+namespace {
+
+future<int>
+sum(future<int> lhs, future<int> rhs) {
+    const int x = co_await std::move(lhs);
+    const int y = co_await std::move(rhs);
+    co_return x + y;
+}
+
+future<void>
+store(future<int> future, int& result) {
+    result = co_await std::move(future);
+}
+
+future<int>
+fail() {
+    throw std::runtime_error("failed");
+    co_return 0;
+}
+
+/// Awaiting consumes the future, so lvalues must be moved explicitly.
+template<class T>
+constexpr bool awaitable_lvalue = requires(T& future) { operator co_await(future); };
+
+static_assert(!awaitable_lvalue<future<int>>, "awaiting an lvalue future must not compile");
+
+} // namespace
+
+TEST(coroutine, AwaitReadyFuture) {
+    EXPECT_EQ(3, sum(make_ready_future<int>::value(1), make_ready_future<int>::value(2)).get());
+}
+
+TEST(coroutine, AwaitFutureFulfilledFromAnotherThread) {
+    promise<int> promise;
+    auto future = sum(make_ready_future<int>::value(1), promise.get_future());
+
+    EXPECT_FALSE(future.ready());
+
+    std::thread thread([&promise] {
+        promise.set_value(41);
+    });
+    thread.join();
+
+    EXPECT_EQ(42, future.get());
+}
+
+TEST(coroutine, ReturnVoid) {
+    int result = 0;
+    store(make_ready_future<int>::value(42), result).get();
+
+    EXPECT_EQ(42, result);
+}
+
+TEST(coroutine, PropagatesException) {
+    EXPECT_THROW(fail().get(), std::runtime_error);
+}
+
+TEST(coroutine, PropagatesAwaitedException) {
+    int result = 0;
+    EXPECT_THROW(store(make_ready_future<int>::error(std::runtime_error("failed")), result).get(),
+                 std::runtime_error);
+}
+
+TEST(coroutine, FramePoolReusesFrames) {
+    auto pool = detail::coroutine::frame_pool_t::local();
+    ASSERT_NE(nullptr, pool);
+
+    void* ptr = pool->allocate(100);
+    pool->deallocate(ptr, 100);
+
+    EXPECT_EQ(ptr, pool->allocate(128));
+    pool->deallocate(ptr, 128);
+}
+
+TEST(coroutine, FrameReleasedAfterPoolDestruction) {
+    typedef detail::coroutine::frame_allocator_t allocator_type;
+
+    std::thread([] {
+        struct frame_t {
+            void* ptr = nullptr;
+
+            ~frame_t() {
+                allocator_type::operator delete(ptr, 100);
+            }
+        };
+
+        // Constructed before the pool, so it is destroyed after it.
+        static thread_local frame_t frame;
+        frame.ptr = allocator_type::operator new(100);
+    }).join();
+}
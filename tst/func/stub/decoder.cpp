@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <msgpack.hpp>
+
+#include <cocaine/errors.hpp>
+
+#include <cocaine/framework/message.hpp>
+
+#include <cocaine/framework/detail/decoder.hpp>
+
+using namespace cocaine;
+using namespace cocaine::framework;
+using namespace cocaine::framework::detail;
+
+namespace {
+
+/// Packs a frame with a large raw argument followed by the beginning of the next frame.
+std::string
+frames(std::size_t& size) {
+    msgpack::sbuffer buffer;
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+
+    packer.pack_array(3);
+    packer.pack(42);
+    packer.pack(0);
+    packer.pack_array(2);
+    packer.pack(std::string(100000, 'x'));
+    packer.pack(std::vector<int>{ 1, -2, 300000 });
+
+    size = buffer.size();
+
+    packer.pack_array(3);
+
+    return std::string(buffer.data(), buffer.size());
+}
+
+} // namespace
+
+TEST(frame_walker_t, WalksFrameArrivingByPieces) {
+    std::size_t expected;
+    const auto data = frames(expected);
+
+    for (std::size_t step : { 1, 7, 4096, 1 << 20 }) {
+        frame_walker_t walker;
+
+        std::size_t size = 0;
+        std::error_code ec;
+        do {
+            size = std::min(size + step, data.size());
+            ec.clear();
+            const auto result = walker.walk(data.data(), size, ec);
+            if (!ec) {
+                EXPECT_EQ(expected, result);
+            }
+        } while (ec == error::insufficient_bytes);
+
+        EXPECT_FALSE(ec);
+        EXPECT_LE(expected, size);
+    }
+}
+
+TEST(frame_walker_t, RejectsNeverUsedType) {
+    frame_walker_t walker;
+
+    const char data[] = { '\xc1' };
+    std::error_code ec;
+    walker.walk(data, sizeof(data), ec);
+
+    EXPECT_EQ(error::parse_error, ec);
+}
+
+TEST(decoder_t, DecodesFrameArrivingByPieces) {
+    std::size_t expected;
+    const auto data = frames(expected);
+
+    decoder_t decoder;
+    decoded_message message(boost::none);
+
+    std::size_t size = 0;
+    std::size_t consumed = 0;
+    std::error_code ec;
+    do {
+        size = std::min(size + 1000, data.size());
+        ec.clear();
+        consumed = decoder.decode(data.data(), size, message, ec);
+    } while (ec == error::insufficient_bytes);
+
+    ASSERT_FALSE(ec);
+    EXPECT_EQ(expected, consumed);
+    EXPECT_EQ(42u, message.span());
+    EXPECT_EQ(0u, message.type());
+}
@@ -0,0 +1,89 @@
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <cocaine/framework/detail/metrics.hpp>
+
+using namespace cocaine::framework;
+using namespace cocaine::framework::detail::metrics;
+
+using namespace testing;
+
+TEST(histogram_t, IndexIsExactForSmallValues) {
+    for (std::uint64_t value = 0; value < histogram_t::SUBBUCKETS; ++value) {
+        EXPECT_EQ(value, histogram_t::index(value));
+        EXPECT_EQ(value, histogram_t::upper_bound(histogram_t::index(value)));
+    }
+}
+
+TEST(histogram_t, UpperBoundContainsValue) {
+    for (std::uint64_t value : { 16ULL, 17ULL, 31ULL, 32ULL, 1000ULL, 123456789ULL, ~0ULL }) {
+        const auto id = histogram_t::index(value);
+        ASSERT_LT(id, histogram_t::BUCKETS);
+
+        const auto bound = histogram_t::upper_bound(id);
+        EXPECT_LE(value, bound);
+        EXPECT_LE(bound - value, value / histogram_t::SUBBUCKETS);
+    }
+}
+
+TEST(histogram_t, Quantiles) {
+    histogram_t histogram;
+    for (std::uint64_t value = 1; value <= 1000; ++value) {
+        histogram.record(value);
+    }
+
+    const auto snapshot = histogram.snapshot();
+    EXPECT_EQ(1000u, snapshot.count);
+    EXPECT_EQ(500500u, snapshot.sum);
+    EXPECT_DOUBLE_EQ(500.5, snapshot.mean());
+
+    EXPECT_NEAR(500, snapshot.quantile(0.5), 500 / histogram_t::SUBBUCKETS);
+    EXPECT_NEAR(990, snapshot.quantile(0.99), 990 / histogram_t::SUBBUCKETS);
+    EXPECT_NEAR(1000, snapshot.max(), 1000 / histogram_t::SUBBUCKETS);
+}
+
+TEST(histogram_t, EmptySnapshot) {
+    histogram_t histogram;
+
+    const auto snapshot = histogram.snapshot();
+    EXPECT_EQ(0u, snapshot.count);
+    EXPECT_EQ(0u, snapshot.quantile(0.99));
+    EXPECT_EQ(0u, snapshot.max());
+}
+
+TEST(counter_t, ConcurrentIncrements) {
+    counter_t counter;
+
+    std::vector<std::thread> threads;
+    for (int id = 0; id < 4; ++id) {
+        threads.emplace_back([&counter] {
+            for (int i = 0; i < 10000; ++i) {
+                counter.inc();
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(40000u, counter.load());
+}
+
+TEST(registry_t, Snapshot) {
+    registry_t registry;
+    registry.counter("requests").inc(3);
+    registry.gauge("channels").inc(2);
+    registry.gauge("channels").dec();
+    registry.histogram("latency").record(42);
+
+    // Metrics are created once and then returned by reference.
+    EXPECT_EQ(&registry.counter("requests"), &registry.counter("requests"));
+
+    const auto snapshot = registry.snapshot();
+    EXPECT_EQ(3u, snapshot.counters.at("requests"));
+    EXPECT_EQ(1, snapshot.gauges.at("channels"));
+    EXPECT_EQ(1u, snapshot.histograms.at("latency").count);
+}
@@ -0,0 +1,361 @@
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cocaine/idl/logging.hpp>
+#include <cocaine/idl/node.hpp>
+#include <cocaine/idl/storage.hpp>
+#include <cocaine/idl/streaming.hpp>
+
+#include <cocaine/common.hpp>
+#include <cocaine/traits/attributes.hpp>
+#include <cocaine/traits/enum.hpp>
+#include <cocaine/traits/error_code.hpp>
+
+#include <cocaine/framework/error.hpp>
+#include <cocaine/framework/manager.hpp>
+#include <cocaine/framework/service.hpp>
+
+#include "../../util/stub.hpp"
+#include "../../util/wait.hpp"
+
+using namespace cocaine;
+using namespace cocaine::framework;
+
+using namespace testing;
+
+namespace {
+
+typedef io::protocol<io::app::enqueue::dispatch_type>::scope app_upstream;
+
+class service_fixture : public ::testing::Test {
+protected:
+    testing::util::runtime_t runtime;
+    std::unique_ptr<service_manager_t> manager;
+
+    void SetUp() override {
+        const auto locator = runtime.endpoint();
+        const std::vector<service_manager_t::endpoint_type> endpoints = {
+            { boost::asio::ip::address::from_string(locator.address().to_string()), locator.port() }
+        };
+
+        manager.reset(new service_manager_t(endpoints, 1));
+    }
+};
+
+/// Returns the error code the given future is failed with.
+std::error_code
+error_of(task<void>::future_type& future) {
+    try {
+        future.get();
+    } catch (const std::system_error& err) {
+        return err.code();
+    }
+
+    return std::error_code();
+}
+
+/// The Locator, which accepts connections without ever replying, so connection attempts hang.
+class silent_locator_fixture : public ::testing::Test {
+protected:
+    boost::asio::io_service io;
+    boost::asio::ip::tcp::acceptor acceptor;
+    std::unique_ptr<service_manager_t> manager;
+
+    silent_locator_fixture() :
+        acceptor(io, boost::asio::ip::tcp::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), 0))
+    {}
+
+    void SetUp() override {
+        const std::vector<service_manager_t::endpoint_type> endpoints = { acceptor.local_endpoint() };
+        manager.reset(new service_manager_t(endpoints, 1));
+
+        // Hanging attempts are never completed, so there is nothing to wait for.
+        manager->shutdown_policy(service_manager_t::shutdown_policy_t::force);
+
+        reconnect_policy_t policy;
+        policy.backoff_min = std::chrono::milliseconds(10);
+        policy.park_timeout = std::chrono::milliseconds(100);
+        policy.park_limit = 4;
+        manager->reconnect_policy(policy);
+    }
+};
+
+} // namespace
+
+TEST(service, MuteEvents) {
+    EXPECT_TRUE(is_mute<io::log::emit>::value);
+    EXPECT_FALSE(is_mute<io::storage::read>::value);
+    EXPECT_FALSE(is_mute<io::app::enqueue>::value);
+
+    EXPECT_TRUE((std::is_same<void, invocation_result<io::log::emit>::type>::value));
+}
+
+TEST_F(service_fixture, InvokeMuteEvent) {
+    auto logger = manager->create<io::log_tag>("logging");
+    logger.connect().get();
+
+    const auto channels = manager->metrics().gauges.at("session.channels");
+
+    for (int i = 0; i < 10; ++i) {
+        logger.invoke<io::log::emit>(logging::info, std::string("app/testing"), std::string("le message")).get();
+    }
+
+    // Mute events reach the service, but never occupy the channel map.
+    EXPECT_TRUE(testing::util::eventually([&] { return runtime.logged() == 10; }));
+    EXPECT_EQ(channels, manager->metrics().gauges.at("session.channels"));
+}
+
+TEST_F(service_fixture, AccountsFirstResponseLatency) {
+    auto storage = manager->create<io::storage_tag>("storage");
+    storage.connect().get();
+
+    const auto count = [&] {
+        return manager->metrics().histograms.at("session.response.latency").count;
+    };
+
+    const auto before = count();
+    storage.invoke<io::storage::read>(std::string("collection"), std::string("key")).get();
+
+    // The latency is recorded right after the response is delivered.
+    EXPECT_TRUE(testing::util::eventually([&] { return count() == before + 1; }));
+}
+
+TEST(service_manager, ResolvesLocatorHostsLazily) {
+    testing::util::runtime_t runtime;
+
+    const auto locator = runtime.endpoint();
+    service_manager_t manager({ std::make_tuple(locator.address().to_string(), locator.port()) }, 1);
+
+    auto storage = manager.create<io::storage_tag>("storage");
+    EXPECT_EQ(testing::util::runtime_t::VALUE, storage.invoke<io::storage::read>(std::string("collection"), std::string("key")).get());
+    EXPECT_EQ(1u, manager.endpoints().size());
+}
+
+TEST_F(service_fixture, CreateSharesSession) {
+    auto first = manager->create<io::storage_tag>("storage");
+    first.connect().get();
+
+    auto second = manager->create<io::storage_tag>("storage");
+    EXPECT_TRUE(second.connect().ready());
+    EXPECT_EQ(first.native_handle(), second.native_handle());
+
+    auto echo = manager->create<io::app_tag>("echo");
+    echo.connect().get();
+    EXPECT_NE(first.native_handle(), echo.native_handle());
+}
+
+TEST_F(service_fixture, EvictsIdleServices) {
+    manager->idle_timeout(std::chrono::milliseconds(50));
+
+    auto storage = manager->create<io::storage_tag>("storage");
+    storage.connect().get();
+    {
+        auto echo = manager->create<io::app_tag>("echo");
+        echo.connect().get();
+    }
+
+    EXPECT_EQ(2, manager->metrics().gauges.at("manager.services"));
+
+    // The idle service is evicted without creating any more handles, while the used one is kept.
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    EXPECT_EQ(1, manager->metrics().gauges.at("manager.services"));
+    EXPECT_TRUE(storage.connect().ready());
+
+    const auto connects = manager->metrics().counters.at("service.connects");
+    manager->create<io::app_tag>("echo").connect().get();
+    EXPECT_EQ(connects + 1, manager->metrics().counters.at("service.connects"));
+}
+
+TEST_F(service_fixture, Warmup) {
+    manager->warmup({ "storage", "echo" }).get();
+
+    auto storage = manager->create<io::storage_tag>("storage");
+    auto echo = manager->create<io::app_tag>("echo");
+
+    EXPECT_TRUE(storage.connect().ready());
+    EXPECT_TRUE(echo.connect().ready());
+}
+
+TEST_F(service_fixture, WarmupReportsFailure) {
+    auto future = manager->warmup({ "storage", "unknown" });
+
+    EXPECT_THROW(future.get(), service_not_found);
+    EXPECT_TRUE(manager->create<io::storage_tag>("storage").connect().ready());
+}
+
+TEST_F(service_fixture, ReconnectParksRequestsDuringBackoff) {
+    auto unknown = manager->create<io::storage_tag>("unknown");
+    EXPECT_THROW(unknown.connect().get(), service_not_found);
+
+    const auto connects = manager->metrics().counters.at("service.connects");
+
+    std::vector<task<void>::future_type> futures;
+    for (int i = 0; i < 10; ++i) {
+        futures.push_back(unknown.connect());
+    }
+
+    for (auto& future : futures) {
+        EXPECT_THROW(future.get(), service_not_found);
+    }
+
+    // All requests issued during the backoff are served by a single delayed attempt.
+    EXPECT_EQ(connects + 1, manager->metrics().counters.at("service.connects"));
+}
+
+TEST_F(service_fixture, InvokeMany) {
+    auto storage = manager->create<io::storage_tag>("storage");
+
+    std::vector<std::tuple<std::string, std::string>> args;
+    for (int id = 0; id < 16; ++id) {
+        args.emplace_back("collection", std::to_string(id));
+    }
+
+    auto futures = storage.invoke_many<io::storage::read>(std::move(args));
+    ASSERT_EQ(16u, futures.size());
+
+    for (auto& future : futures) {
+        EXPECT_EQ(testing::util::runtime_t::VALUE, future.get());
+    }
+}
+
+TEST_F(service_fixture, InvokeManyOpensIndependentChannels) {
+    auto echo = manager->create<io::app_tag>("echo");
+
+    std::vector<std::tuple<std::string>> args = {
+        std::make_tuple(std::string("first")),
+        std::make_tuple(std::string("second"))
+    };
+
+    auto futures = echo.invoke_many<io::app::enqueue>(std::move(args));
+    ASSERT_EQ(2u, futures.size());
+
+    auto first = futures[0].get();
+    auto second = futures[1].get();
+
+    second.tx.send<app_upstream::chunk>(std::string("2")).get();
+    first.tx.send<app_upstream::chunk>(std::string("1")).get();
+
+    EXPECT_EQ(std::string("1"), *first.rx.recv().get());
+    EXPECT_EQ(std::string("2"), *second.rx.recv().get());
+}
+
+TEST_F(service_fixture, InvokeManyWithNoArguments) {
+    auto storage = manager->create<io::storage_tag>("storage");
+
+    EXPECT_TRUE(storage.invoke_many<io::storage::read>(std::vector<std::tuple<std::string, std::string>>()).empty());
+}
+
+TEST_F(service_fixture, SendRawBlob) {
+    auto echo = manager->create<io::app_tag>("echo");
+    auto channel = echo.invoke<io::app::enqueue>(std::string("ping")).get();
+
+    const auto payload = std::make_shared<const std::string>(4 * 1024 * 1024, 'x');
+
+    auto tx = channel.tx.send_raw<app_upstream::chunk>(blob_t(payload)).get();
+    EXPECT_EQ(*payload, *channel.rx.recv().get());
+
+    tx.send<app_upstream::choke>().get();
+}
+
+TEST(blob_t, ConvertsFromSharedBuffers) {
+    EXPECT_TRUE((std::is_convertible<std::shared_ptr<std::string>, blob_t>::value));
+    EXPECT_TRUE((std::is_convertible<std::shared_ptr<const std::string>, blob_t>::value));
+    EXPECT_TRUE((std::is_convertible<std::shared_ptr<std::vector<char>>, blob_t>::value));
+    EXPECT_TRUE((std::is_convertible<std::shared_ptr<const std::vector<char>>, blob_t>::value));
+    EXPECT_FALSE((std::is_convertible<std::shared_ptr<int>, blob_t>::value));
+
+    const auto buffer = std::make_shared<std::vector<char>>(16, 'x');
+    const blob_t blob(buffer);
+    EXPECT_EQ(buffer->data(), blob.data());
+    EXPECT_EQ(16u, blob.size());
+}
+
+TEST_F(service_fixture, SendRawMutableBlob) {
+    auto echo = manager->create<io::app_tag>("echo");
+    auto channel = echo.invoke<io::app::enqueue>(std::string("ping")).get();
+
+    auto tx = channel.tx.send_raw<app_upstream::chunk>(std::make_shared<std::string>("le message")).get();
+    EXPECT_EQ("le message", *channel.rx.recv().get());
+
+    tx.send<app_upstream::choke>().get();
+}
+
+TEST_F(service_fixture, ReleasingReceiverRevokesChannel) {
+    auto echo = manager->create<io::app_tag>("echo");
+    echo.connect().get();
+
+    const auto channels = manager->metrics().gauges.at("session.channels");
+
+    auto channel = echo.invoke<io::app::enqueue>(std::string("ping")).get();
+    EXPECT_EQ(channels + 1, manager->metrics().gauges.at("session.channels"));
+
+    // The sender is still alive, but nobody waits for replies anymore.
+    auto tx = std::move(channel.tx);
+    {
+        auto rx = std::move(channel.rx);
+    }
+    EXPECT_EQ(channels, manager->metrics().gauges.at("session.channels"));
+
+    tx.send<app_upstream::choke>().get();
+}
+
+TEST_F(silent_locator_fixture, ConnectTimeout) {
+    auto storage = manager->create<io::storage_tag>("storage");
+
+    const auto start = std::chrono::steady_clock::now();
+    auto future = storage.connect();
+    EXPECT_EQ(std::error_code(error::connect_timeout), error_of(future));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+
+    // The hanging attempt is abandoned with the expired requests, so the next request starts
+    // another one after the backoff instead of waiting for the first one forever.
+    auto next = storage.connect();
+    EXPECT_EQ(std::error_code(error::connect_timeout), error_of(next));
+    EXPECT_EQ(2u, manager->metrics().counters.at("service.connects"));
+}
+
+TEST_F(silent_locator_fixture, ConnectQueueOverflow) {
+    auto storage = manager->create<io::storage_tag>("storage");
+
+    std::vector<task<void>::future_type> futures;
+    for (int i = 0; i < 4; ++i) {
+        futures.push_back(storage.connect());
+    }
+
+    auto overflow = storage.connect();
+    ASSERT_TRUE(overflow.ready());
+    EXPECT_EQ(std::error_code(error::connect_queue_overflow), error_of(overflow));
+
+    for (auto& future : futures) {
+        EXPECT_EQ(std::error_code(error::connect_timeout), error_of(future));
+    }
+}
+
+TEST_F(service_fixture, ReconnectFailsFastDuringLongBackoff) {
+    reconnect_policy_t policy;
+    policy.backoff_min = std::chrono::seconds(10);
+    policy.park_timeout = std::chrono::milliseconds(100);
+    manager->reconnect_policy(policy);
+
+    auto unknown = manager->create<io::storage_tag>("unknown");
+    EXPECT_THROW(unknown.connect().get(), service_not_found);
+
+    const auto connects = manager->metrics().counters.at("service.connects");
+
+    // The next attempt is too far away to wait for it, so the request fails with the last error
+    // at once.
+    auto future = unknown.connect();
+    ASSERT_TRUE(future.ready());
+    EXPECT_THROW(future.get(), service_not_found);
+    EXPECT_EQ(connects, manager->metrics().counters.at("service.connects"));
+}
@@ -0,0 +1,70 @@
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include <cocaine/framework/detail/slab.hpp>
+
+using namespace cocaine::framework::detail;
+
+namespace {
+
+struct block_t {
+    int& alive;
+    int tx;
+    int rx;
+
+    explicit block_t(int& alive) : alive(alive), tx(0), rx(0) { ++alive; }
+    ~block_t() { --alive; }
+};
+
+} // namespace
+
+TEST(slab_t, RecyclesReleasedBlocks) {
+    slab_t slab;
+
+    auto first = slab.allocate(64);
+    slab.deallocate(first, 64);
+
+    auto second = slab.allocate(64);
+    EXPECT_EQ(first, second);
+
+    slab.deallocate(second, 64);
+}
+
+TEST(slab_t, PassesOtherSizesThrough) {
+    slab_t slab(1);
+
+    auto block = slab.allocate(64);
+    auto other = slab.allocate(128);
+    slab.deallocate(other, 128);
+
+    auto next = slab.allocate(64);
+    EXPECT_NE(other, next);
+
+    slab.deallocate(next, 64);
+    slab.deallocate(block, 64);
+}
+
+TEST(slab_allocator_t, KeepsBlockUntilAllHandlesAreReleased) {
+    auto slab = std::make_shared<slab_t>();
+    int alive = 0;
+
+    std::shared_ptr<int> tx;
+    std::shared_ptr<int> rx;
+    {
+        auto block = std::allocate_shared<block_t>(slab_allocator_t<block_t>(slab), alive);
+        tx = std::shared_ptr<int>(block, &block->tx);
+        rx = std::shared_ptr<int>(block, &block->rx);
+    }
+
+    EXPECT_EQ(1, alive);
+    tx.reset();
+    EXPECT_EQ(1, alive);
+    rx.reset();
+    EXPECT_EQ(0, alive);
+
+    // The slab outlives its allocators, while the memory is returned into it.
+    auto block = std::allocate_shared<block_t>(slab_allocator_t<block_t>(slab), alive);
+    slab.reset();
+    EXPECT_EQ(1, alive);
+}
@@ -0,0 +1,81 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <cocaine/idl/logging.hpp>
+#include <cocaine/trace/trace.hpp>
+
+#include <cocaine/framework/manager.hpp>
+#include <cocaine/framework/service.hpp>
+#include <cocaine/framework/trace_logger.hpp>
+
+#include <cocaine/framework/detail/bounded_queue.hpp>
+
+#include "../../util/stub.hpp"
+#include "../../util/wait.hpp"
+
+using namespace cocaine;
+using namespace cocaine::framework;
+
+using namespace testing;
+
+TEST(bounded_queue_t, RejectsCapacityNotPowerOfTwo) {
+    EXPECT_THROW(detail::bounded_queue_t<int>(0), std::invalid_argument);
+    EXPECT_THROW(detail::bounded_queue_t<int>(1), std::invalid_argument);
+    EXPECT_THROW(detail::bounded_queue_t<int>(6), std::invalid_argument);
+    EXPECT_EQ(8u, detail::bounded_queue_t<int>(8).capacity());
+}
+
+TEST(bounded_queue_t, ForcePushDropsOldest) {
+    detail::bounded_queue_t<int> queue(4);
+
+    for (int id = 0; id < 4; ++id) {
+        int value = id;
+        EXPECT_EQ(0u, queue.force_push(value));
+    }
+
+    int value = 4;
+    EXPECT_EQ(1u, queue.force_push(value));
+
+    for (int expected = 1; expected <= 4; ++expected) {
+        int popped = -1;
+        ASSERT_TRUE(queue.pop(popped));
+        EXPECT_EQ(expected, popped);
+    }
+
+    int popped;
+    EXPECT_FALSE(queue.pop(popped));
+}
+
+TEST(internal_logger_t, Stats) {
+    testing::util::runtime_t runtime;
+
+    const auto locator = runtime.endpoint();
+    service_manager_t manager({
+        { boost::asio::ip::address::from_string(locator.address().to_string()), locator.port() }
+    }, 1);
+
+    internal_logger_t logger(manager.logger());
+
+    // Records of untraced requests are not even queued.
+    logger.log("untraced");
+    EXPECT_EQ(0u, logger.stats().queued);
+
+    {
+        trace_t trace(1, 1, 0, "test");
+        trace_t::restore_scope_t scope(trace);
+
+        for (int id = 0; id < 10; ++id) {
+            logger.log("traced");
+        }
+    }
+
+    EXPECT_EQ(10u, logger.stats().queued);
+    EXPECT_TRUE(testing::util::eventually([&] { return logger.stats().sent == 10; }));
+    EXPECT_EQ(0u, logger.stats().dropped);
+
+    // All records reach the logging service.
+    EXPECT_TRUE(testing::util::eventually([&] { return runtime.logged() == 10; }));
+}
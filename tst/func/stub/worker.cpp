@@ -0,0 +1,580 @@
+#include <unistd.h>
+
+#include <cstdlib>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <asio/io_service.hpp>
+#include <asio/local/stream_protocol.hpp>
+
+#include <msgpack.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cocaine/idl/rpc.hpp>
+#include <cocaine/idl/streaming.hpp>
+
+#include <cocaine/common.hpp>
+#include <cocaine/traits/vector.hpp>
+
+#include <cocaine/framework/encoder.hpp>
+#include <cocaine/framework/worker.hpp>
+#include <cocaine/framework/worker/http.hpp>
+
+#include <cocaine/framework/detail/metrics.hpp>
+#include <cocaine/framework/detail/worker/meter.hpp>
+
+#include "../../util/stub.hpp"
+#include "../../util/wait.hpp"
+
+using namespace cocaine;
+using namespace cocaine::framework;
+
+using namespace testing;
+
+namespace {
+
+typedef io::protocol<io::worker::rpc::invoke::dispatch_type>::scope incoming;
+typedef io::protocol<io::worker::rpc::invoke::upstream_type>::scope outgoing;
+
+/// Channel id, reserved for control messages.
+const std::uint64_t CONTROL = 1;
+
+/// A message written by the worker into an invocation channel.
+struct reply_t {
+    std::uint64_t type;
+
+    /// Chunk payload, empty for other messages.
+    std::string data;
+};
+
+/// Packs the given request as the first chunk of an HTTP event.
+std::string
+pack(const worker::http_request_t& request, const std::string& body) {
+    msgpack::sbuffer buffer;
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    io::type_traits<worker::http_request_t>::pack(packer, request, body);
+
+    return std::string(buffer.data(), buffer.size());
+}
+
+/// Packs the given value as a chunk payload.
+template<class T>
+std::string
+packed(const T& value) {
+    msgpack::sbuffer buffer;
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+    packer << value;
+
+    return std::string(buffer.data(), buffer.size());
+}
+
+/// Unpacks the HTTP response head from the given chunk.
+worker::http_response_t
+unpack(const std::string& chunk) {
+    msgpack::unpacked unpacked;
+    msgpack::unpack(&unpacked, chunk.data(), chunk.size());
+
+    worker::http_response_t response;
+    io::type_traits<worker::http_response_t>::unpack(unpacked.get(), response);
+    return response;
+}
+
+/// Drives a worker through a fake runtime listening on a unix socket.
+///
+/// Handlers must be registered before the worker is started.
+class worker_fixture : public ::testing::Test {
+protected:
+    std::string path;
+    asio::io_service loop;
+    std::unique_ptr<asio::local::stream_protocol::acceptor> acceptor;
+
+    std::unique_ptr<worker_t> app;
+    std::thread thread;
+
+    std::unique_ptr<testing::util::worker_runtime_t> runtime;
+    std::uint64_t span;
+
+    void SetUp() override {
+        path = "/tmp/cocaine-framework-worker-" + std::to_string(::getpid()) + ".sock";
+        ::unlink(path.c_str());
+
+        acceptor.reset(new asio::local::stream_protocol::acceptor(loop, asio::local::stream_protocol::endpoint(path)));
+
+        ::setenv("COCAINE_FRAMEWORK_WORKER_THREADS", "1", 1);
+
+        std::vector<std::string> args = {
+            "test", "--app", "test", "--uuid", "uuid", "--endpoint", path, "--locator", "127.0.0.1:10053"
+        };
+
+        std::vector<char*> argv;
+        for (auto& arg : args) {
+            argv.push_back(&arg[0]);
+        }
+
+        app.reset(new worker_t(options_t(static_cast<int>(argv.size()), argv.data())));
+        span = CONTROL + 1;
+    }
+
+    void TearDown() override {
+        if (runtime) {
+            runtime->send<io::worker::terminate>(CONTROL, 0, std::string("test is over"));
+
+            // Drain everything until the worker confirms the termination.
+            msgpack::unpacked result;
+            while (runtime->read(result)) {
+                const auto& frame = result.get().via.array;
+                if (frame.ptr[0].as<std::uint64_t>() == CONTROL &&
+                    frame.ptr[1].as<std::uint64_t>() == io::event_traits<io::worker::terminate>::id)
+                {
+                    break;
+                }
+            }
+
+            thread.join();
+        }
+
+        ::unlink(path.c_str());
+    }
+
+    /// Starts the worker and waits for its handshake.
+    void
+    start() {
+        thread = std::thread([this] {
+            app->run();
+        });
+
+        asio::local::stream_protocol::socket socket(loop);
+        acceptor->accept(socket);
+
+        runtime.reset(new testing::util::worker_runtime_t(::dup(socket.native_handle())));
+        socket.close();
+
+        msgpack::unpacked result;
+        ASSERT_TRUE(runtime->read(result));
+    }
+
+    /// Invokes the given event, sending the given chunks and closing the stream. Returns the
+    /// channel id.
+    std::uint64_t
+    invoke(const std::string& event, const std::vector<std::string>& chunks) {
+        encoded_frames_t frames(span);
+        frames.append<io::worker::rpc::invoke>(event);
+        for (const auto& chunk : chunks) {
+            frames.append_raw<incoming::chunk>(chunk);
+        }
+        frames.append<incoming::choke>();
+        runtime->write(frames.data(), frames.size());
+
+        return span++;
+    }
+
+    /// Reads messages of the given channel until it is closed either normally or with an error.
+    std::vector<reply_t>
+    replies(std::uint64_t id) {
+        std::vector<reply_t> result;
+
+        msgpack::unpacked unpacked;
+        while (runtime->read(unpacked)) {
+            const auto& frame = unpacked.get().via.array;
+            if (frame.ptr[0].as<std::uint64_t>() != id) {
+                continue;
+            }
+
+            const auto type = frame.ptr[1].as<std::uint64_t>();
+            const auto chunk = type == io::event_traits<outgoing::chunk>::id;
+
+            result.push_back({ type, chunk ? frame.ptr[2].via.array.ptr[0].as<std::string>() : std::string() });
+
+            if (!chunk) {
+                break;
+            }
+        }
+
+        return result;
+    }
+};
+
+/// Returns true if the given view points into the given chunk.
+bool
+points_into(boost::string_ref view, const worker::chunk_t& chunk) {
+    const auto data = chunk.data();
+    return view.data() >= data.data() && view.data() + view.size() <= data.data() + data.size();
+}
+
+} // namespace
+
+TEST(chunk_t, Empty) {
+    const worker::chunk_t chunk;
+
+    EXPECT_TRUE(chunk.data().empty());
+    EXPECT_EQ("", chunk.to_string());
+}
+
+TEST(chunk_t, SliceSharesOwner) {
+    auto owner = std::make_shared<const std::string>("le message");
+    std::weak_ptr<const std::string> weak(owner);
+
+    boost::optional<worker::chunk_t> slice;
+    {
+        const worker::chunk_t chunk(owner, *owner);
+        owner.reset();
+
+        const auto data = chunk.data();
+        slice = chunk.slice(data.substr(3));
+    }
+
+    // The slice refers to the same memory and keeps it alive on its own.
+    EXPECT_FALSE(weak.expired());
+    EXPECT_EQ("message", slice->to_string());
+    EXPECT_EQ(weak.lock()->data() + 3, slice->data().data());
+
+    slice.reset();
+    EXPECT_TRUE(weak.expired());
+}
+
+TEST(chunk_t, OwnsString) {
+    const worker::chunk_t chunk(std::string("le message"));
+
+    EXPECT_EQ("le message", chunk.to_string());
+    EXPECT_EQ("message", chunk.slice(chunk.data().substr(3)).to_string());
+}
+
+TEST_F(worker_fixture, RecvChunk) {
+    app->on("echo", [](worker::sender tx, worker::receiver rx) {
+        while (auto chunk = rx.recv<worker::chunk_t>().get()) {
+            tx = tx.write(chunk->to_string()).get();
+        }
+    });
+
+    start();
+
+    const auto replies = this->replies(invoke("echo", { "first", "second" }));
+
+    ASSERT_EQ(3u, replies.size());
+    EXPECT_EQ("first", replies[0].data);
+    EXPECT_EQ("second", replies[1].data);
+    EXPECT_EQ(io::event_traits<outgoing::choke>::id, replies[2].type);
+}
+
+TEST_F(worker_fixture, HttpRequestView) {
+    typedef worker::http::event<worker::view_middleware> http_t;
+
+    std::promise<std::tuple<worker::http_request_t, std::string, bool>> received;
+
+    app->on<http_t>("http", [&](http_t::fresh_sender, http_t::fresh_receiver rx) {
+        try {
+            auto result = rx.recv().get();
+
+            const auto& request = std::get<0>(result);
+            auto body = std::get<1>(result).recv<worker::chunk_t>().get();
+
+            // All fields refer to the received frame instead of being copied.
+            bool viewed = points_into(request.method, request.frame) &&
+                points_into(request.uri, request.frame) &&
+                points_into(body->data(), request.frame);
+            for (const auto& header : request.headers) {
+                viewed = viewed && points_into(header.first, request.frame) && points_into(header.second, request.frame);
+            }
+
+            received.set_value(std::make_tuple(request.to_request(), body->to_string(), viewed));
+        } catch (...) {
+            received.set_exception(std::current_exception());
+        }
+    });
+
+    start();
+
+    const worker::http_request_t request = { "POST", "/path", "1.1", {{ "Host", "localhost" }, { "X-Id", "42" }} };
+    invoke("http", { pack(request, "le body") });
+
+    const auto result = received.get_future().get();
+    const auto& actual = std::get<0>(result);
+
+    EXPECT_EQ("POST", actual.method);
+    EXPECT_EQ("/path", actual.uri);
+    EXPECT_EQ("1.1", actual.version);
+    EXPECT_EQ(request.headers, actual.headers);
+    EXPECT_EQ("le body", std::get<1>(result));
+    EXPECT_TRUE(std::get<2>(result));
+}
+
+TEST_F(worker_fixture, HttpRequestOwning) {
+    typedef worker::http::event<> http_t;
+
+    std::promise<std::tuple<worker::http_request_t, std::string>> received;
+
+    app->on<http_t>("http", [&](http_t::fresh_sender, http_t::fresh_receiver rx) {
+        try {
+            auto result = rx.recv().get();
+            auto body = std::get<1>(result).recv().get();
+
+            received.set_value(std::make_tuple(std::get<0>(result), *body));
+        } catch (...) {
+            received.set_exception(std::current_exception());
+        }
+    });
+
+    start();
+
+    const worker::http_request_t request = { "GET", "/", "1.1", {{ "Host", "localhost" }} };
+    invoke("http", { pack(request, "le body") });
+
+    const auto result = received.get_future().get();
+
+    EXPECT_EQ("GET", std::get<0>(result).method);
+    EXPECT_EQ(request.headers, std::get<0>(result).headers);
+    EXPECT_EQ("le body", std::get<1>(result));
+}
+
+TEST_F(worker_fixture, WriteMany) {
+    app->on("echo", [](worker::sender tx, worker::receiver) {
+        tx.write(std::vector<boost::string_ref>{ "first", "second" }).get()
+            .write_and_close(std::vector<boost::string_ref>{ "third" }).get();
+    });
+
+    start();
+
+    const auto replies = this->replies(invoke("echo", {}));
+
+    // Each message is sent as a separate chunk.
+    ASSERT_EQ(4u, replies.size());
+    EXPECT_EQ("first", replies[0].data);
+    EXPECT_EQ("second", replies[1].data);
+    EXPECT_EQ("third", replies[2].data);
+    EXPECT_EQ(io::event_traits<outgoing::choke>::id, replies[3].type);
+}
+
+TEST_F(worker_fixture, WriteAndCloseNothing) {
+    app->on("echo", [](worker::sender tx, worker::receiver) {
+        tx.write_and_close(std::vector<boost::string_ref>()).get();
+    });
+
+    start();
+
+    const auto replies = this->replies(invoke("echo", {}));
+
+    ASSERT_EQ(1u, replies.size());
+    EXPECT_EQ(io::event_traits<outgoing::choke>::id, replies[0].type);
+}
+
+TEST(encoded_http_response_t, MatchesPackedResponse) {
+    const worker::http_response_t response = { 404, {{ "Content-Type", "text/plain" }} };
+    const worker::encoded_http_response_t encoded(response);
+
+    const auto actual = unpack(encoded.data().to_string());
+    EXPECT_EQ(404, actual.code);
+    EXPECT_EQ(response.headers, actual.headers);
+}
+
+TEST_F(worker_fixture, HttpSendWithBody) {
+    typedef worker::http::event<> http_t;
+
+    app->on<http_t>("http", [](http_t::fresh_sender tx, http_t::fresh_receiver) {
+        worker::http_response_t response = { 200, {{ "Content-Type", "text/plain" }} };
+        tx.send(std::move(response), "le body").get()
+            .send("le tail").get();
+    });
+
+    start();
+
+    const worker::http_request_t request = { "GET", "/", "1.1", {} };
+    const auto replies = this->replies(invoke("http", { pack(request, "") }));
+
+    ASSERT_EQ(4u, replies.size());
+    EXPECT_EQ(200, unpack(replies[0].data).code);
+    EXPECT_EQ("le body", replies[1].data);
+    EXPECT_EQ("le tail", replies[2].data);
+    EXPECT_EQ(io::event_traits<outgoing::choke>::id, replies[3].type);
+}
+
+TEST_F(worker_fixture, HttpSendEncodedWithBody) {
+    typedef worker::http::event<> http_t;
+
+    const worker::encoded_http_response_t response({ 201, {{ "Location", "/created" }} });
+
+    app->on<http_t>("http", [&](http_t::fresh_sender tx, http_t::fresh_receiver) {
+        tx.send(response, "le body").get();
+    });
+
+    start();
+
+    const worker::http_request_t request = { "POST", "/", "1.1", {} };
+    const auto replies = this->replies(invoke("http", { pack(request, "") }));
+
+    ASSERT_EQ(3u, replies.size());
+    EXPECT_EQ(201, unpack(replies[0].data).code);
+    EXPECT_EQ("le body", replies[1].data);
+    EXPECT_EQ(io::event_traits<outgoing::choke>::id, replies[2].type);
+}
+
+TEST_F(worker_fixture, HttpSendAndClose) {
+    typedef worker::http::event<> http_t;
+
+    const worker::encoded_http_response_t encoded({ 202, {} });
+
+    app->on<http_t>("http", [](http_t::fresh_sender tx, http_t::fresh_receiver) {
+        tx.send_and_close(worker::http_response_t{ 200, {} }, "le body").get();
+    });
+
+    app->on<http_t>("http-encoded", [&](http_t::fresh_sender tx, http_t::fresh_receiver) {
+        tx.send_and_close(encoded, "le body").get();
+    });
+
+    start();
+
+    const worker::http_request_t request = { "GET", "/", "1.1", {} };
+
+    for (const auto& event : { std::make_pair("http", 200), std::make_pair("http-encoded", 202) }) {
+        const auto replies = this->replies(invoke(event.first, { pack(request, "") }));
+
+        ASSERT_EQ(3u, replies.size());
+        EXPECT_EQ(event.second, unpack(replies[0].data).code);
+        EXPECT_EQ("le body", replies[1].data);
+        EXPECT_EQ(io::event_traits<outgoing::choke>::id, replies[2].type);
+    }
+}
+
+TEST_F(worker_fixture, RecvUnpacksTypes) {
+    std::promise<std::tuple<int, std::vector<int>, bool>> received;
+
+    app->on("typed", [&](worker::sender, worker::receiver rx) {
+        try {
+            const auto number = rx.recv<int>().get();
+            const auto numbers = rx.recv<std::vector<int>>().get();
+            const auto end = rx.recv<int>().get();
+
+            received.set_value(std::make_tuple(*number, *numbers, !end));
+        } catch (...) {
+            received.set_exception(std::current_exception());
+        }
+    });
+
+    start();
+
+    invoke("typed", { packed(42), packed(std::vector<int>{ 1, 2, 3 }) });
+
+    const auto result = received.get_future().get();
+    EXPECT_EQ(42, std::get<0>(result));
+    EXPECT_EQ((std::vector<int>{ 1, 2, 3 }), std::get<1>(result));
+    EXPECT_TRUE(std::get<2>(result));
+}
+
+TEST_F(worker_fixture, RecvRejectsMismatchedType) {
+    std::promise<void> received;
+
+    app->on("typed", [&](worker::sender, worker::receiver rx) {
+        try {
+            rx.recv<int>().get();
+            received.set_value();
+        } catch (...) {
+            received.set_exception(std::current_exception());
+        }
+    });
+
+    start();
+
+    invoke("typed", { packed(std::string("not a number")) });
+
+    EXPECT_THROW(received.get_future().get(), msgpack::type_error);
+}
+
+TEST_F(worker_fixture, ExposeMetrics) {
+    app->on("echo", [](worker::sender tx, worker::receiver) {
+        tx.write_and_close(std::vector<boost::string_ref>{ "le message" }).get();
+    });
+    app->expose_metrics();
+
+    start();
+
+    this->replies(invoke("echo", {}));
+    const auto replies = this->replies(invoke("__stats__", {}));
+
+    ASSERT_EQ(2u, replies.size());
+    EXPECT_EQ(io::event_traits<outgoing::choke>::id, replies[1].type);
+
+    msgpack::unpacked unpacked;
+    msgpack::unpack(&unpacked, replies[0].data.data(), replies[0].data.size());
+
+    const auto stats = unpacked.get().as<std::map<std::string, msgpack::object>>();
+    ASSERT_EQ(3u, stats.size());
+
+    // Both invocations are accounted, including the one being replied to.
+    const auto counters = stats.at("counters").as<std::map<std::string, std::uint64_t>>();
+    EXPECT_EQ(2u, counters.at("worker.invokes"));
+    EXPECT_EQ(1u, stats.at("gauges").as<std::map<std::string, std::int64_t>>().count("worker.channels"));
+
+    const auto histograms = stats.at("histograms").as<std::map<std::string, std::map<std::string, msgpack::object>>>();
+    const auto& latency = histograms.at("worker.write.latency");
+    for (const auto& key : { "count", "sum", "mean", "max", "p50", "p90", "p99", "p999" }) {
+        EXPECT_EQ(1u, latency.count(key)) << key;
+    }
+}
+
+TEST(meter_t, Lifecycle) {
+    detail::metrics::registry_t registry;
+    detail::worker::event_metrics_t metrics(registry, "event");
+
+    {
+        detail::worker::meter_t meter(metrics);
+        EXPECT_EQ(1u, metrics.invocations.load());
+        EXPECT_EQ(1, metrics.inflight.load());
+
+        meter.on_start();
+        EXPECT_EQ(1u, metrics.wait.snapshot().count);
+
+        // Only the first chunk and the first closing are recorded.
+        meter.on_write();
+        meter.on_write();
+        EXPECT_EQ(1u, metrics.first_chunk.snapshot().count);
+
+        meter.on_error();
+        meter.on_close();
+        EXPECT_EQ(1u, metrics.errors.load());
+        EXPECT_EQ(1u, metrics.close.snapshot().count);
+
+        // The invocation is in-flight until the meter is released.
+        EXPECT_EQ(1, metrics.inflight.load());
+    }
+
+    EXPECT_EQ(0, metrics.inflight.load());
+
+    const auto snapshot = registry.snapshot();
+    EXPECT_EQ(1u, snapshot.counters.at("event.invocations"));
+    EXPECT_EQ(1u, snapshot.histograms.at("event.close").count);
+}
+
+TEST_F(worker_fixture, MetersEvents) {
+    app->on("echo", [](worker::sender tx, worker::receiver) {
+        tx.write_and_close(std::vector<boost::string_ref>{ "le message" }).get();
+    });
+
+    start();
+
+    this->replies(invoke("echo", {}));
+
+    const auto replies = this->replies(invoke("unknown", {}));
+    ASSERT_EQ(1u, replies.size());
+    EXPECT_EQ(io::event_traits<outgoing::error>::id, replies[0].type);
+
+    // Meters are released by the executor thread after the channel is closed.
+    EXPECT_TRUE(testing::util::eventually([&] {
+        const auto gauges = app->metrics().gauges;
+        return gauges.at("worker.events.echo.inflight") == 0 && gauges.at("worker.fallback.inflight") == 0;
+    }));
+
+    const auto metrics = app->metrics();
+    EXPECT_EQ(1u, metrics.counters.at("worker.events.echo.invocations"));
+    EXPECT_EQ(0u, metrics.counters.at("worker.events.echo.errors"));
+    EXPECT_EQ(1u, metrics.histograms.at("worker.events.echo.wait").count);
+    EXPECT_EQ(1u, metrics.histograms.at("worker.events.echo.first_chunk").count);
+    EXPECT_EQ(1u, metrics.histograms.at("worker.events.echo.close").count);
+
+    // Events without a handler are accounted together.
+    EXPECT_EQ(1u, metrics.counters.at("worker.fallback.invocations"));
+    EXPECT_EQ(1u, metrics.counters.at("worker.fallback.errors"));
+}
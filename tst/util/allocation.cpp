@@ -0,0 +1,35 @@
+#include "allocation.hpp"
+
+#include <atomic>
+
+namespace {
+
+std::atomic<std::uint64_t> allocations(0);
+
+thread_local bool ignored = false;
+
+} // namespace
+
+void testing::util::allocation::record() noexcept {
+    if (!ignored) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::uint64_t testing::util::allocation::count() noexcept {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+void testing::util::allocation::ignore_current_thread() noexcept {
+    ignored = true;
+}
+
+testing::util::allocation::suspend_t::suspend_t() noexcept :
+    ignored(::ignored)
+{
+    ::ignored = true;
+}
+
+testing::util::allocation::suspend_t::~suspend_t() {
+    ::ignored = ignored;
+}
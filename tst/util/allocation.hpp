@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+
+namespace testing {
+
+namespace util {
+
+namespace allocation {
+
+/// Accounts a single dynamic memory allocation made by the current thread.
+///
+/// Called by the global `operator new` replacement from operator_new.cpp, which must be linked only
+/// into executables, that need such accounting, because it affects every allocation they make.
+void record() noexcept;
+
+/// Returns the number of dynamic memory allocations made since the program start.
+///
+/// Always zero, unless operator_new.cpp is linked into the executable.
+std::uint64_t count() noexcept;
+
+/// Excludes allocations made by the current thread from the counting.
+///
+/// Useful for in-process stub servers, which should not affect the measured client.
+void ignore_current_thread() noexcept;
+
+/// Excludes allocations made by the current thread from the counting until destroyed.
+class suspend_t {
+    bool ignored;
+
+public:
+    suspend_t() noexcept;
+    ~suspend_t();
+
+    suspend_t(const suspend_t&) = delete;
+    suspend_t& operator=(const suspend_t&) = delete;
+};
+
+/// Returns the number of allocations made by all threads, except ignored ones, while executing
+/// the given function.
+template<class F>
+std::uint64_t
+measure(F fn) {
+    const auto before = count();
+    fn();
+    return count() - before;
+}
+
+} // namespace allocation
+
+} // namespace util
+
+} // namespace testing
+
+/// Expects the given statement to make at most the given number of allocations.
+///
+/// The statement is executed twice, the first run warms up lazily initialized state, like thread
+/// local buffers or connections, and is not counted. The counted number is recorded as the
+/// "allocations" property of the test, so it shows up in the `--gtest_output=xml` report.
+#define EXPECT_ALLOCATIONS_LE(budget, statement)                                                   \
+    do {                                                                                           \
+        statement;                                                                                 \
+        const auto allocations = ::testing::util::allocation::measure([&] { statement; });         \
+        ::testing::Test::RecordProperty("allocations", static_cast<int>(allocations));             \
+        EXPECT_LE(allocations, static_cast<std::uint64_t>(budget))                                 \
+            << "allocation budget exceeded by '" #statement "'";                                   \
+    } while (false)
@@ -56,6 +56,14 @@ public:
     void stop() {
         work.reset();
     }
+
+    /// Stops the server loop immediately, abandoning all pending operations.
+    ///
+    /// Required for servers, that accept connections in a loop and never run out of work.
+    void halt() {
+        work.reset();
+        loop.stop();
+    }
 };
 
 class client_t {
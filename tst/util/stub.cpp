@@ -0,0 +1,303 @@
+#include "stub.hpp"
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <system_error>
+
+#include <cocaine/idl/locator.hpp>
+#include <cocaine/idl/logging.hpp>
+#include <cocaine/idl/node.hpp>
+#include <cocaine/idl/storage.hpp>
+#include <cocaine/idl/streaming.hpp>
+
+#include <cocaine/common.hpp>
+#include <cocaine/errors.hpp>
+#include <cocaine/traits/endpoint.hpp>
+#include <cocaine/traits/error_code.hpp>
+#include <cocaine/traits/graph.hpp>
+#include <cocaine/traits/vector.hpp>
+
+#include "allocation.hpp"
+
+namespace fw = cocaine::framework;
+
+using namespace cocaine;
+
+using namespace testing::util;
+
+namespace {
+
+const std::size_t READ_CHUNK_SIZE = 64 * 1024;
+
+template<class Event, class... Args>
+std::string
+encode(std::uint64_t span, Args&&... args) {
+    fw::encoded_frames_t frames(span);
+    frames.append<Event>(std::forward<Args>(args)...);
+    return std::string(frames.data(), frames.size());
+}
+
+void
+accept(asio::ip::tcp::acceptor& acceptor, fw::detail::loop_t& loop, connection_t::handler_type handler) {
+    auto socket = std::make_shared<asio::ip::tcp::socket>(loop);
+
+    acceptor.async_accept(*socket, [&acceptor, &loop, socket, handler](const std::error_code& ec) {
+        if (ec) {
+            return;
+        }
+
+        std::make_shared<connection_t>(std::move(*socket), handler)->start();
+        accept(acceptor, loop, handler);
+    });
+}
+
+/// Replies to resolve requests with the given endpoint of "echo", "storage" and "logging" services.
+void
+on_locator(const frame_t& frame, connection_t& connection, std::uint16_t echo, std::uint16_t storage, std::uint16_t logging) {
+    typedef io::protocol<io::locator::resolve::upstream_type>::scope protocol;
+
+    std::string name;
+    frame.args.via.array.ptr[0].convert(&name);
+
+    std::uint16_t port = 0;
+    unsigned int version = 0;
+    if (name == "echo") {
+        port = echo;
+        version = io::protocol<io::app_tag>::version::value;
+    } else if (name == "storage") {
+        port = storage;
+        version = io::protocol<io::storage_tag>::version::value;
+    } else if (name == "logging") {
+        port = logging;
+        version = io::protocol<io::log_tag>::version::value;
+    } else {
+        connection.write(encode<protocol::error>(
+            frame.span,
+            make_error_code(error::locator_errors::service_not_available),
+            "service '" + name + "' is not available"
+        ));
+        return;
+    }
+
+    const std::vector<asio::ip::tcp::endpoint> endpoints = {
+        { asio::ip::address_v4::loopback(), port }
+    };
+
+    connection.write(encode<protocol::value>(frame.span, endpoints, version, io::graph_root_t()));
+}
+
+/// Echoes every chunk of the application protocol channel back and closes it on choke.
+void
+on_echo(const frame_t& frame, connection_t& connection) {
+    typedef io::protocol<io::app::enqueue::dispatch_type>::scope incoming;
+    typedef io::protocol<io::app::enqueue::upstream_type>::scope outgoing;
+
+    if (connection.channels.insert(frame.span).second) {
+        // The first frame of each channel is the invocation itself.
+        return;
+    }
+
+    switch (frame.type) {
+    case io::event_traits<incoming::chunk>::id: {
+        fw::encoded_frames_t frames(frame.span);
+        const auto& raw = frame.args.via.array.ptr[0].via.raw;
+        frames.append_raw<outgoing::chunk>(boost::string_ref(raw.ptr, raw.size));
+        connection.write(std::string(frames.data(), frames.size()));
+        break;
+    }
+    case io::event_traits<incoming::error>::id:
+    case io::event_traits<incoming::choke>::id:
+        connection.channels.erase(frame.span);
+        connection.write(encode<outgoing::choke>(frame.span));
+        break;
+    default:
+        break;
+    }
+}
+
+/// Replies to every read request with the same value.
+void
+on_storage(const frame_t& frame, connection_t& connection) {
+    typedef io::protocol<io::storage::read::upstream_type>::scope protocol;
+
+    if (frame.type == io::event_traits<io::storage::read>::id) {
+        connection.write(encode<protocol::value>(frame.span, runtime_t::VALUE));
+    }
+}
+
+/// Counts emitted log records. Emit is a mute event, so nothing is replied.
+void
+on_logging(const frame_t& frame, connection_t&, std::atomic<std::uint64_t>& records) {
+    if (frame.type == io::event_traits<io::log::emit>::id) {
+        ++records;
+    }
+}
+
+} // namespace
+
+connection_t::connection_t(asio::ip::tcp::socket socket, handler_type handler) :
+    socket(std::move(socket)),
+    handler(std::move(handler)),
+    writing(false)
+{}
+
+void
+connection_t::start() {
+    read();
+}
+
+void
+connection_t::write(std::string data) {
+    pending.push_back(std::move(data));
+
+    if (!writing) {
+        flush();
+    }
+}
+
+void
+connection_t::read() {
+    unpacker.reserve_buffer(READ_CHUNK_SIZE);
+
+    socket.async_read_some(
+        asio::buffer(unpacker.buffer(), unpacker.buffer_capacity()),
+        std::bind(&connection_t::on_read, shared_from_this(), std::placeholders::_1, std::placeholders::_2)
+    );
+}
+
+void
+connection_t::on_read(const std::error_code& ec, std::size_t size) {
+    if (ec) {
+        return;
+    }
+
+    unpacker.buffer_consumed(size);
+
+    msgpack::unpacked result;
+    while (unpacker.next(&result)) {
+        const msgpack::object& object = result.get();
+
+        const frame_t frame = {
+            object.via.array.ptr[0].as<std::uint64_t>(),
+            object.via.array.ptr[1].as<std::uint64_t>(),
+            object.via.array.ptr[2]
+        };
+
+        handler(frame, *this);
+    }
+
+    read();
+}
+
+void
+connection_t::flush() {
+    writing = true;
+
+    socket.async_write_some(
+        asio::buffer(pending.front()),
+        std::bind(&connection_t::on_write, shared_from_this(), std::placeholders::_1, std::placeholders::_2)
+    );
+}
+
+void
+connection_t::on_write(const std::error_code& ec, std::size_t size) {
+    writing = false;
+
+    if (ec) {
+        return;
+    }
+
+    auto& front = pending.front();
+    if (size < front.size()) {
+        front.erase(0, size);
+    } else {
+        pending.pop_front();
+    }
+
+    if (!pending.empty()) {
+        flush();
+    }
+}
+
+server_t::server_t(connection_t::handler_type handler) :
+    port_(util::port()),
+    server(port_, [handler](asio::ip::tcp::acceptor& acceptor, fw::detail::loop_t& loop) {
+        allocation::ignore_current_thread();
+
+        accept(acceptor, loop, handler);
+        loop.run();
+    })
+{}
+
+server_t::~server_t() {
+    server.halt();
+}
+
+std::uint16_t
+server_t::port() const noexcept {
+    return port_;
+}
+
+const std::string runtime_t::VALUE(64, 'v');
+
+runtime_t::runtime_t() :
+    records(0),
+    echo(&on_echo),
+    storage(&on_storage),
+    logging(std::bind(&on_logging, std::placeholders::_1, std::placeholders::_2, std::ref(records))),
+    locator(std::bind(&on_locator, std::placeholders::_1, std::placeholders::_2, echo.port(), storage.port(), logging.port()))
+{}
+
+auto
+runtime_t::endpoint() const -> asio::ip::tcp::endpoint {
+    return asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), locator.port());
+}
+
+auto
+runtime_t::logged() const -> std::uint64_t {
+    return records.load();
+}
+
+worker_runtime_t::worker_runtime_t(int fd) :
+    fd(fd)
+{}
+
+worker_runtime_t::~worker_runtime_t() {
+    ::close(fd);
+}
+
+void
+worker_runtime_t::write(const char* data, std::size_t size) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    while (size > 0) {
+        const auto written = ::write(fd, data, size);
+        if (written < 0) {
+            throw std::system_error(errno, std::system_category(), "write");
+        }
+
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+bool
+worker_runtime_t::read(msgpack::unpacked& result) {
+    while (!unpacker.next(&result)) {
+        unpacker.reserve_buffer(READ_CHUNK_SIZE);
+
+        const auto size = ::read(fd, unpacker.buffer(), unpacker.buffer_capacity());
+        if (size < 0) {
+            throw std::system_error(errno, std::system_category(), "read");
+        }
+
+        if (size == 0) {
+            return false;
+        }
+
+        unpacker.buffer_consumed(static_cast<std::size_t>(size));
+    }
+
+    return true;
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include <asio/ip/tcp.hpp>
+
+#include <msgpack.hpp>
+
+#include <cocaine/framework/encoder.hpp>
+
+#include "net.hpp"
+
+namespace testing {
+
+namespace util {
+
+/// Single incoming frame of the cocaine protocol.
+struct frame_t {
+    std::uint64_t span;
+    std::uint64_t type;
+    const msgpack::object& args;
+};
+
+/// Server side connection, which decodes incoming frames and passes them to the handler.
+///
+/// All operations are performed in the server event loop thread.
+class connection_t : public std::enable_shared_from_this<connection_t> {
+public:
+    typedef std::function<void(const frame_t&, connection_t&)> handler_type;
+
+    /// Channels opened by the remote side, for handlers' use.
+    std::set<std::uint64_t> channels;
+
+private:
+    asio::ip::tcp::socket socket;
+    handler_type handler;
+
+    msgpack::unpacker unpacker;
+
+    std::deque<std::string> pending;
+    bool writing;
+
+public:
+    connection_t(asio::ip::tcp::socket socket, handler_type handler);
+
+    void
+    start();
+
+    /// Enqueues the given encoded data for writing.
+    void
+    write(std::string data);
+
+private:
+    void
+    read();
+
+    void
+    on_read(const std::error_code& ec, std::size_t size);
+
+    void
+    flush();
+
+    void
+    on_write(const std::error_code& ec, std::size_t size);
+};
+
+/// TCP server, accepting connections on an OS selected port and serving all of them in a single
+/// thread.
+class server_t {
+    std::uint16_t port_;
+    util::server_t server;
+
+public:
+    explicit
+    server_t(connection_t::handler_type handler);
+
+    ~server_t();
+
+    std::uint16_t
+    port() const noexcept;
+};
+
+/// In-process stub of the cocaine runtime, consisting of the locator and three services:
+///  - "echo", speaking the application protocol, which replies with every chunk received.
+///  - "storage", which replies to every read request with the same value.
+///  - "logging", which counts emitted records.
+///
+/// The locator resolves only these services, replying with an error to others.
+class runtime_t {
+    /// Number of records received by the logging service, which must outlive the servers.
+    std::atomic<std::uint64_t> records;
+
+    server_t echo;
+    server_t storage;
+    server_t logging;
+    server_t locator;
+
+public:
+    /// Value returned from the storage on every read.
+    static const std::string VALUE;
+
+    runtime_t();
+
+    /// Returns the locator endpoint.
+    auto
+    endpoint() const -> asio::ip::tcp::endpoint;
+
+    /// Returns the number of records received by the logging service.
+    auto
+    logged() const -> std::uint64_t;
+};
+
+/// Fake runtime side of a single worker connection, operating on a connected unix socket.
+///
+/// All operations are blocking. Writes may be made from multiple threads, for example by a load
+/// generating thread and a reading thread, which replies to heartbeats, so they are serialized.
+class worker_runtime_t {
+    int fd;
+    std::mutex mutex;
+
+    msgpack::unpacker unpacker;
+
+public:
+    /// Takes the ownership of the given socket descriptor.
+    explicit
+    worker_runtime_t(int fd);
+
+    ~worker_runtime_t();
+
+    void
+    write(const char* data, std::size_t size);
+
+    template<class Event, class... Args>
+    void
+    send(std::uint64_t span, Args&&... args) {
+        cocaine::framework::encoded_frames_t frames(span);
+        frames.append<Event>(std::forward<Args>(args)...);
+        write(frames.data(), frames.size());
+    }
+
+    /// Reads the next frame. Returns false on EOF.
+    bool
+    read(msgpack::unpacked& result);
+};
+
+} // namespace util
+
+} // namespace testing
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <chrono>
+#include <thread>
+
+namespace testing {
+
+namespace util {
+
+/// Waits until the given predicate holds, giving up after a few seconds.
+template<class F>
+bool
+eventually(F predicate) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    return true;
+}
+
+} // namespace util
+
+} // namespace testing